@@ -0,0 +1,233 @@
+/*
+ * Smart Sheet - On-device benchmarks
+ */
+
+#include "benchmark.h"
+#include "hal/clock.h"
+#include "bitplane.h"
+#include "expr.h"
+#include "library.h"
+#include "oscillator.h"
+#include "shaping.h"
+#include "drivers/motor_driver.h"
+
+// ==================== COMMIT BENCHMARK ====================
+uint32_t benchmarkCommit(const uint8_t* duties, int frames) {
+  uint32_t start = Clock::cycles();
+  for (int f = 0; f < frames; f++) {
+    uint8_t flip = f & 1 ? 0 : 0xFF;
+    Motors::forEach([duties, flip](int i) {
+      MotorDriver::write(i, duties[i] ^ flip);
+    });
+    MotorDriver::commit();
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+
+  // Put back what the pipeline and any kick or brake left on the outputs
+  unsigned long now = Clock::millis();
+  Motors::forEach([now](int i) {
+    MotorDriver::write(i, appliedDuty(i, now));
+  });
+  MotorDriver::commit();
+  return elapsed / frames;
+}
+
+// ==================== BIT-PLANE BENCHMARK ====================
+uint32_t benchmarkBitplanes(const uint8_t* values, int frames, bool scalar) {
+  uint8_t frame[16];
+  uint16_t planes[BITPLANES];
+  volatile uint16_t sink = 0;
+  memcpy(frame, values, sizeof(frame));
+
+  uint32_t start = Clock::cycles();
+  for (int f = 0; f < frames; f++) {
+    frame[f & 15]++;  // Defeat hoisting the pack out of the loop
+    if (scalar) {
+      packBitplanesScalar(frame, 16, planes);
+    } else {
+      packBitplanes16(frame, 16, planes);
+    }
+    sink += planes[f & 7];
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / frames;
+}
+
+// ==================== PATTERN BENCHMARK ====================
+uint32_t benchmarkExpression(const char* source, int intensity, int frames) {
+  ExprProgram program;
+  int errorPos;
+  if (compileExpression(source, program, errorPos) != EXPR_OK) {
+    return 0;
+  }
+
+  MotorFrame frame;
+  ExprInputs inputs;
+  inputs.n = NUM_MOTORS << 16;
+  inputs.intensity = intensity << 16;
+
+  uint32_t start = Clock::cycles();
+  for (int f = 0; f < frames; f++) {
+    inputs.t = f * (EXPR_TICK_MS << 16) / 1000;
+    renderExpression(program, inputs, frame);
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / frames;
+}
+
+uint32_t benchmarkWave(const PatternLayer& layer, int frames) {
+  MotorFrame frame;
+
+  uint32_t start = Clock::cycles();
+  for (int f = 0; f < frames; f++) {
+    renderWaveStep(layer, f % NUM_MOTORS, frame);
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / frames;
+}
+
+uint32_t benchmarkPatternTick(const PatternLayer& layer, int ticks) {
+  PatternLayer scratch = layer;
+  MotorFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  unsigned long now = scratch.lastUpdate;
+
+  uint32_t start = Clock::cycles();
+  for (int t = 0; t < ticks; t++) {
+    now += BENCH_TICK_MS;
+    if (scratch.mode == MODE_CONSTANT) {
+      frame.values[t % NUM_MOTORS] ^= 1;  // Make every tick rewrite the frame
+    }
+    generatePattern(scratch, frame, now);
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / ticks;
+}
+
+uint32_t benchmarkOscillatorRender(int frames) {
+  MotorFrame frame;
+  volatile uint8_t sink = 0;
+
+  uint32_t start = Clock::cycles();
+  for (int f = 0; f < frames; f++) {
+    renderOscillators(frame);
+    sink += frame.values[f % NUM_MOTORS];
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / frames;
+}
+
+// ==================== COMMAND BENCHMARK ====================
+uint32_t benchmarkCommands(CommandHandler handler, const char* const* commands,
+                           int count, int rounds) {
+  uint32_t start = Clock::cycles();
+  for (int r = 0; r < rounds; r++) {
+    for (int c = 0; c < count; c++) {
+      handler(String(commands[c]));
+    }
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / (rounds * count);
+}
+
+uint32_t benchmarkReply(void (*sender)(), int rounds) {
+  uint32_t start = Clock::cycles();
+  for (int r = 0; r < rounds; r++) {
+    sender();
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / rounds;
+}
+
+// ==================== LIBRARY BENCHMARK ====================
+uint32_t benchmarkLibraryLookup(int rounds) {
+  int count = getLibraryCount();
+  if (count == 0) {
+    return 0;
+  }
+  volatile uint32_t sink = 0;
+
+  uint32_t start = Clock::cycles();
+  for (int r = 0; r < rounds; r++) {
+    const LibraryEntry* entry = findLibraryEntry(getLibraryEntry(r % count)->id);
+    sink += entry->offset;
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return elapsed / rounds;
+}
+
+uint32_t benchmarkLibraryStream() {
+  const uint32_t* words = (const uint32_t*)libraryImage();
+  uint32_t bytes = ((const LibraryHeader*)words)->imageSize & ~3u;
+  uint32_t sum = 0;
+
+  uint32_t start = Clock::cycles();
+  for (uint32_t k = 0; k < bytes / 4; k++) {
+    sum += words[k];
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  volatile uint32_t sink = sum;
+  (void)sink;
+
+  if (elapsed == 0) {
+    return 0;
+  }
+  return (uint32_t)((uint64_t)bytes * Clock::cyclesPerMicro() * 1000000 / elapsed / 1024);
+}
+
+uint32_t benchmarkFrameDecode() {
+  const LibraryEntry* entry = NULL;
+  for (int k = 0; k < getLibraryCount() && entry == NULL; k++) {
+    if (getLibraryEntry(k)->kind == LIB_FRAMES_LZ) {
+      entry = getLibraryEntry(k);
+    }
+  }
+  if (entry == NULL) {
+    return 0;
+  }
+
+  static FrameDecoder decoder;             // Keeps the window off the loop task stack
+  uint8_t row[MOTOR_BANK_MAX] = {0};
+  int frames = 0;
+
+  uint32_t start = Clock::cycles();
+  beginFrameDecode(decoder, libraryRecord(*entry), entry->length);
+  while (frames < entry->frameCount && decodeFrameRow(decoder, row, entry->motors)) {
+    frames++;
+  }
+  uint32_t elapsed = Clock::cycles() - start;
+  return frames ? elapsed / frames : 0;
+}
+
+// ==================== RESULT FORMATTING ====================
+uint32_t commandsPerSecond(uint32_t cycles) {
+  if (cycles == 0) {
+    return 0;
+  }
+  return (uint64_t)Clock::cyclesPerMicro() * 1000000 / cycles;
+}
+
+// Cycle figures are in CPU cycles on the ESP32 and nanoseconds on host
+// builds; cyclesPerUs says which, so runs are only compared like for like
+String formatBenchmarkJson(const BenchmarkResults& r) {
+  String json = "{\"driver\":\"" + String(r.driver) + "\"" +
+                ",\"cyclesPerUs\":" + String(Clock::cyclesPerMicro()) +
+                ",\"commit\":" + String(r.commit) +
+                ",\"bitplane\":{\"packed\":" + String(r.bitplanePacked) +
+                ",\"scalar\":" + String(r.bitplaneScalar) + "}" +
+                ",\"tick\":{\"CONSTANT\":" + String(r.tickConstant) +
+                ",\"WAVE\":" + String(r.tickWave) +
+                ",\"OSC\":" + String(r.tickOscillator) +
+                ",\"EXPR\":" + String(r.expression) + "}" +
+                ",\"render\":{\"wave\":" + String(r.waveRender) + "}" +
+                ",\"parser\":{\"cyclesPerCommand\":" + String(r.command) +
+                ",\"commandsPerSec\":" + String(commandsPerSecond(r.command)) + "}" +
+                ",\"reply\":{\"status\":" + String(r.statusReply) + "}";
+  if (r.library) {
+    json += ",\"library\":{\"lookup\":" + String(r.libraryLookup) +
+            ",\"streamKBs\":" + String(r.libraryStream) +
+            ",\"lzFrame\":" + String(r.frameDecode) + "}";
+  }
+  json += "}";
+  return json;
+}
@@ -0,0 +1,93 @@
+/*
+ * Smart Sheet - On-device benchmarks
+ * Cycle-accurate timing of hot paths using the CPU cycle counter
+ */
+
+#ifndef SMARTSHEET_BENCHMARK_H
+#define SMARTSHEET_BENCHMARK_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "patterns.h"
+
+const int BENCH_COMMIT_FRAMES = 1000;
+const int BENCH_BITPLANE_FRAMES = 1000;
+const int BENCH_PATTERN_FRAMES = 200;
+const int BENCH_LOOKUP_ROUNDS = 1000;
+const int BENCH_COMMAND_ROUNDS = 50;
+const int BENCH_REPLY_ROUNDS = 200;
+const int BENCH_TICK_ROUNDS = 100;
+const unsigned long BENCH_TICK_MS = 1000;   // Past every mode's step interval
+
+// PATTERN: equivalent of the wave at its default 100 ms step
+#define BENCH_WAVE_EXPRESSION "(sin((i - t*10)/n*6.2832) + 1)/2*I"
+
+// Average CPU cycles to write and commit one full frame through the
+// active motor driver. Frames alternate between duties and its complement
+// so every channel changes and drivers that skip unchanged channels do
+// real work; the shaper's current output is written back afterwards.
+uint32_t benchmarkCommit(const uint8_t* duties, int frames);
+
+// Average CPU cycles to pack one 16-motor frame into bit-planes, with the
+// 8x8 transpose kernel and with the bit-at-a-time reference
+uint32_t benchmarkBitplanes(const uint8_t* values, int frames, bool scalar);
+
+// Average CPU cycles to render one frame of a PATTERN: expression, and of
+// the hand-written wave renderer. The expression returns 0 if it does
+// not compile.
+uint32_t benchmarkExpression(const char* source, int intensity, int frames);
+uint32_t benchmarkWave(const PatternLayer& layer, int frames);
+
+// Average CPU cycles per generatePattern() call that produces a new
+// frame, run on a copy of the layer so the live layer keeps its timing.
+// Only modes whose state lives in the layer (CONSTANT, WAVE, EXPR) can be
+// driven this way; the shared oscillator bank is timed by its render.
+uint32_t benchmarkPatternTick(const PatternLayer& layer, int ticks);
+uint32_t benchmarkOscillatorRender(int frames);
+
+// Average CPU cycles per command through the command processor, cycling
+// through the given commands. Replies should be muted by the caller.
+typedef void (*CommandHandler)(String command);
+uint32_t benchmarkCommands(CommandHandler handler, const char* const* commands,
+                           int count, int rounds);
+
+// Average CPU cycles to build and send one reply (muted by the caller)
+uint32_t benchmarkReply(void (*sender)(), int rounds);
+
+// Average CPU cycles per library index lookup, over every stored id
+uint32_t benchmarkLibraryLookup(int rounds);
+
+// KB/s reading the whole library image out of mapped flash, starting cold
+// where the image is larger than the flash cache
+uint32_t benchmarkLibraryStream();
+
+// Average CPU cycles to decode one frame of the first compressed library
+// record, 0 if there is none
+uint32_t benchmarkFrameDecode();
+
+// ==================== RESULTS ====================
+struct BenchmarkResults {
+  const char* driver;
+  uint32_t commit;                   // Cycles per frame write + commit
+  uint32_t bitplanePacked;
+  uint32_t bitplaneScalar;
+  uint32_t expression;               // Cycles per frame, reference expression
+  uint32_t waveRender;
+  uint32_t tickConstant;             // Cycles per pattern tick
+  uint32_t tickWave;
+  uint32_t tickOscillator;
+  uint32_t command;                  // Cycles per parsed command
+  uint32_t statusReply;              // Cycles per STATUS reply
+  bool library;                      // Library figures below are valid
+  uint32_t libraryLookup;
+  uint32_t libraryStream;            // KB/s
+  uint32_t frameDecode;
+};
+
+// Commands per second from a cycles-per-command figure
+uint32_t commandsPerSecond(uint32_t cycles);
+
+// One-line JSON object, for saving and diffing runs (tools/bench_compare.py)
+String formatBenchmarkJson(const BenchmarkResults& results);
+
+#endif
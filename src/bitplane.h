@@ -0,0 +1,60 @@
+/*
+ * Smart Sheet - Bit-plane packing
+ * Converts per-motor 8-bit intensities into bit-planes for bit-angle
+ * modulation: plane b holds bit b of every motor, one motor per bit.
+ *
+ * Eight motors are packed at a time with a 64-bit 8x8 bit-matrix
+ * transpose (three delta swaps) instead of 64 shift/mask/or steps.
+ * Header-only and free of Arduino dependencies so it can be benchmarked
+ * off-target.
+ */
+
+#ifndef SMARTSHEET_BITPLANE_H
+#define SMARTSHEET_BITPLANE_H
+
+#include <stdint.h>
+#include <string.h>
+
+const int BITPLANES = 8;
+
+// Byte i, bit b of the input moves to byte b, bit i of the output
+static inline uint64_t transposeBits8x8(uint64_t x) {
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+// Loads up to 8 bytes little-endian, zero-filling past count
+static inline uint64_t loadBytes8(const uint8_t* values, int count) {
+  uint64_t x = 0;
+  memcpy(&x, values, count < 8 ? count : 8);
+  return x;
+}
+
+// Packs up to 16 intensities into 8 planes of 16 bits:
+// bit i of planes[b] = bit b of values[i]
+static inline void packBitplanes16(const uint8_t* values, int count, uint16_t* planes) {
+  uint64_t lo = transposeBits8x8(loadBytes8(values, count));
+  uint64_t hi = count > 8 ? transposeBits8x8(loadBytes8(values + 8, count - 8)) : 0;
+  for (int b = 0; b < BITPLANES; b++) {
+    planes[b] = (uint16_t)((lo >> (8 * b)) & 0xFF) | (uint16_t)(((hi >> (8 * b)) & 0xFF) << 8);
+  }
+}
+
+// Reference implementation, one bit at a time
+static inline void packBitplanesScalar(const uint8_t* values, int count, uint16_t* planes) {
+  for (int b = 0; b < BITPLANES; b++) {
+    uint16_t plane = 0;
+    for (int i = 0; i < count; i++) {
+      plane |= ((values[i] >> b) & 1) << i;
+    }
+    planes[b] = plane;
+  }
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Smart Sheet - Per-motor calibration
+ * LUT generation and NVS persistence
+ */
+
+#include "calibration.h"
+#include <Preferences.h>
+
+// ==================== STORAGE KEYS ====================
+static const char* PREFS_NAMESPACE = "smartsheet";
+static const char* PREFS_CAL_KEY = "cal";
+
+// ==================== GLOBAL VARIABLES ====================
+uint8_t calibrationLut[NUM_MOTORS][256];
+static MotorCalibration calibrations[NUM_MOTORS];
+
+// ==================== HELPERS ====================
+static bool isValidCalibration(const MotorCalibration& cal) {
+  return cal.startThreshold <= CAL_THRESHOLD_MAX &&
+         cal.gainPercent >= CAL_GAIN_MIN && cal.gainPercent <= CAL_GAIN_MAX &&
+         cal.gammaX100 >= CAL_GAMMA_MIN && cal.gammaX100 <= CAL_GAMMA_MAX;
+}
+
+static void setDefaults(MotorCalibration& cal) {
+  cal.startThreshold = CAL_DEFAULT_THRESHOLD;
+  cal.gainPercent = CAL_DEFAULT_GAIN;
+  cal.gammaX100 = CAL_DEFAULT_GAMMA;
+}
+
+// ==================== LUT BUILDER ====================
+// Runs only on calibration change, so float math is fine here
+static void buildLut(int motor) {
+  const MotorCalibration& cal = calibrations[motor];
+  uint8_t* lut = calibrationLut[motor];
+  float gamma = cal.gammaX100 / 100.0f;
+  float span = (PWM_MAX_DUTY - cal.startThreshold) * (cal.gainPercent / 100.0f);
+
+  lut[0] = 0; // Zero intensity always means motor off
+  for (int v = 1; v < 256; v++) {
+    float x = (float)v / PWM_MAX_DUTY;
+    float duty = cal.startThreshold + span * powf(x, gamma);
+    if (duty > PWM_MAX_DUTY) {
+      duty = PWM_MAX_DUTY;
+    }
+    lut[v] = (uint8_t)(duty + 0.5f);
+  }
+}
+
+// ==================== PERSISTENCE ====================
+static void saveCalibration() {
+  Preferences prefs;
+  if (!prefs.begin(PREFS_NAMESPACE, false)) {
+    Serial.println("ERROR: Failed to open calibration storage");
+    return;
+  }
+  prefs.putBytes(PREFS_CAL_KEY, calibrations, sizeof(calibrations));
+  prefs.end();
+}
+
+static bool loadCalibration() {
+  Preferences prefs;
+  if (!prefs.begin(PREFS_NAMESPACE, true)) {
+    return false;
+  }
+
+  bool loaded = false;
+  if (prefs.getBytesLength(PREFS_CAL_KEY) == sizeof(calibrations)) {
+    loaded = prefs.getBytes(PREFS_CAL_KEY, calibrations, sizeof(calibrations)) == sizeof(calibrations);
+  }
+  prefs.end();
+
+  // Reject anything out of range rather than driving motors with it
+  for (int i = 0; loaded && i < NUM_MOTORS; i++) {
+    loaded = isValidCalibration(calibrations[i]);
+  }
+  return loaded;
+}
+
+// ==================== PUBLIC API ====================
+void initCalibration() {
+  if (!loadCalibration()) {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      setDefaults(calibrations[i]);
+    }
+    Serial.println("Calibration: using defaults");
+  } else {
+    Serial.println("Calibration: loaded from NVS");
+  }
+
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    buildLut(i);
+  }
+}
+
+bool setMotorCalibration(int motor, const MotorCalibration& cal) {
+  if (motor < 0 || motor >= NUM_MOTORS || !isValidCalibration(cal)) {
+    return false;
+  }
+
+  calibrations[motor] = cal;
+  buildLut(motor);
+  saveCalibration();
+  return true;
+}
+
+const MotorCalibration& getMotorCalibration(int motor) {
+  return calibrations[motor];
+}
+
+void resetCalibration() {
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    setDefaults(calibrations[i]);
+    buildLut(i);
+  }
+  saveCalibration();
+}
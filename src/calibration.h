@@ -0,0 +1,53 @@
+/*
+ * Smart Sheet - Per-motor calibration
+ * Maps logical intensity (0-255) to PWM duty through one precomputed
+ * lookup table per motor, so the commit path is a single array read.
+ *
+ * Each table folds in:
+ *   - start threshold: lowest duty at which the ERM motor reliably spins
+ *   - gain: unit-to-unit strength correction above the threshold
+ *   - gamma: perceptual curve (100 = linear)
+ *
+ * Tables are rebuilt only when calibration changes and the settings are
+ * persisted in NVS so they survive a reboot.
+ */
+
+#ifndef SMARTSHEET_CALIBRATION_H
+#define SMARTSHEET_CALIBRATION_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ==================== CALIBRATION LIMITS ====================
+const int CAL_THRESHOLD_MAX = 200;
+const int CAL_GAIN_MIN = 50;       // percent
+const int CAL_GAIN_MAX = 150;
+const int CAL_GAMMA_MIN = 50;      // gamma * 100
+const int CAL_GAMMA_MAX = 300;
+
+// ==================== CALIBRATION DEFAULTS ====================
+const int CAL_DEFAULT_THRESHOLD = 51;   // ~20% duty, typical ERM start point
+const int CAL_DEFAULT_GAIN = 100;
+const int CAL_DEFAULT_GAMMA = 100;
+
+struct MotorCalibration {
+  uint8_t startThreshold;          // Duty sent for the lowest non-zero intensity
+  uint8_t gainPercent;             // Scale applied to the span above threshold
+  uint16_t gammaX100;              // Perceptual gamma * 100
+};
+
+// One 256-entry duty table per motor, indexed by logical intensity
+extern uint8_t calibrationLut[NUM_MOTORS][256];
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initCalibration();
+bool setMotorCalibration(int motor, const MotorCalibration& cal);
+const MotorCalibration& getMotorCalibration(int motor);
+void resetCalibration();
+
+// Commit-path lookup: logical intensity -> calibrated PWM duty
+inline uint8_t calibratedDuty(int motor, int intensity) {
+  return calibrationLut[motor][intensity];
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Smart Sheet - Hardware configuration
+ * Pin map and PWM settings shared by all firmware modules
+ */
+
+#ifndef SMARTSHEET_CONFIG_H
+#define SMARTSHEET_CONFIG_H
+
+#include "motor_bank.h"
+
+// ==================== PIN CONFIGURATION ====================
+#if defined(MOTOR_DRIVER_PCA9685)
+// Motors live on PCA9685 expanders, 16 channels per chip
+#ifndef PCA9685_CHIPS
+#define PCA9685_CHIPS 2
+#endif
+const int PCA9685_CHANNELS = 16;
+const int PCA9685_SDA_PIN = 21;
+const int PCA9685_SCL_PIN = 22;
+const uint32_t PCA9685_I2C_HZ = 1000000;     // Fast-mode Plus
+const uint8_t PCA9685_BASE_ADDRESS = 0x40;
+const uint32_t PCA9685_PWM_FREQUENCY = 1526; // Chip maximum
+
+typedef ChannelBank<PCA9685_CHIPS * PCA9685_CHANNELS> Motors;
+#elif defined(MOTOR_DRIVER_BAM)
+// Bit-angle modulation streamed over I2S0 parallel output lines
+#ifndef BAM_DATA_PINS
+#define BAM_DATA_PINS 18, 19, 21, 22, 23, 25, 26, 27
+#endif
+constexpr int BAM_LINE_PINS[] = {BAM_DATA_PINS};
+constexpr int BAM_LINES = sizeof(BAM_LINE_PINS) / sizeof(BAM_LINE_PINS[0]);
+
+#if defined(BAM_SHIFT_REGISTER)
+// Each data line feeds one 74HC595; clock and latch are shared
+const int BAM_CLOCK_PIN = 32;
+const int BAM_LATCH_PIN = 33;
+const int BAM_REGISTER_BITS = 8;
+typedef ChannelBank<BAM_LINES * BAM_REGISTER_BITS> Motors;
+#else
+// Each data line drives one motor's MOSFET gate directly
+typedef MotorBank<BAM_DATA_PINS> Motors;
+#endif
+#else
+// Override per build environment, e.g. -D MOTOR_PIN_LIST=18,19,21,...
+#ifndef MOTOR_PIN_LIST
+#define MOTOR_PIN_LIST 18, 19, 21, 22, 23, 25, 26, 27
+#endif
+
+typedef MotorBank<MOTOR_PIN_LIST> Motors;
+#endif
+
+constexpr const int* MOTOR_PINS = Motors::pins;
+constexpr int NUM_MOTORS = Motors::size;
+
+// ==================== PWM CONFIGURATION ====================
+const int PWM_FREQUENCY = 5000;    // 5 KHz
+const int PWM_RESOLUTION = 8;      // 8-bit resolution (0-255)
+const int PWM_MAX_DUTY = 255;
+
+#endif
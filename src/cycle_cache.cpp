@@ -0,0 +1,132 @@
+/*
+ * Smart Sheet - Cycle cache
+ * Static table pool, compile task and lock-free publication. Each table
+ * carries a sequence count that is odd while the task rewrites it; a
+ * reader that sees it odd or changed across its copy treats the lookup as
+ * a miss, so neither side ever waits for the other.
+ */
+
+#include "cycle_cache.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+const uint32_t CYCLE_NONE = 0xFFFFFFFF;
+const int CYCLE_TASK_STACK = 2048;
+const int CYCLE_TASK_PRIORITY = 1;
+const int CYCLE_TASK_CORE = 0;
+
+struct CycleEntry {
+  volatile uint32_t published;       // (key << 8) | table slot, or CYCLE_NONE
+  volatile bool pending;
+  uint32_t pendingKey;
+  PatternLayer params;
+  CycleRenderer render;
+  int period;
+};
+
+// ==================== TABLE POOL ====================
+// Entry e owns tables 2e and 2e+1
+static MotorFrame tables[CYCLE_ENTRIES * 2][CYCLE_MAX_PERIOD];
+static uint32_t tableSeq[CYCLE_ENTRIES * 2];
+static CycleEntry entries[CYCLE_ENTRIES];
+static portMUX_TYPE requestLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t compileTask = NULL;
+
+// ==================== COMPILE TASK ====================
+static void compileTaskLoop(void* param) {
+  (void)param;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    compilePendingCycles();
+  }
+}
+
+void compilePendingCycles() {
+  for (int e = 0; e < CYCLE_ENTRIES; e++) {
+    CycleEntry& entry = entries[e];
+    if (!entry.pending) {
+      continue;
+    }
+
+    portENTER_CRITICAL(&requestLock);
+    uint32_t key = entry.pendingKey;
+    PatternLayer params = entry.params;
+    CycleRenderer render = entry.render;
+    int period = entry.period;
+    entry.pending = false;
+    portEXIT_CRITICAL(&requestLock);
+
+    // Fill whichever table is not published; a loop() read still in
+    // flight on it sees the odd sequence and misses
+    uint32_t live = __atomic_load_n(&entry.published, __ATOMIC_ACQUIRE);
+    uint8_t target = live == CYCLE_NONE ? 2 * e : (live & 0xFF) ^ 1;
+    uint32_t seq = tableSeq[target];
+    __atomic_store_n(&tableSeq[target], seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (int step = 0; step < period; step++) {
+      render(params, step, tables[target][step]);
+    }
+    __atomic_store_n(&tableSeq[target], seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry.published, (key << 8) | target, __ATOMIC_RELEASE);
+  }
+}
+
+// ==================== PUBLIC API ====================
+void initCycleCache() {
+  for (int e = 0; e < CYCLE_ENTRIES; e++) {
+    entries[e].published = CYCLE_NONE;
+    entries[e].pending = false;
+  }
+
+  if (CYCLE_ENTRIES > 0) {
+    xTaskCreatePinnedToCore(compileTaskLoop, "cycle_cache", CYCLE_TASK_STACK, NULL,
+                            CYCLE_TASK_PRIORITY, &compileTask, CYCLE_TASK_CORE);
+  }
+  Serial.printf("Cycle cache: %d layers, %d bytes\n", CYCLE_ENTRIES,
+                (int)sizeof(tables));
+}
+
+void requestCycleCompile(int layerId, uint32_t key, const PatternLayer& params,
+                         CycleRenderer render, int period) {
+  if (layerId >= CYCLE_ENTRIES || period > CYCLE_MAX_PERIOD) {
+    return;
+  }
+
+  CycleEntry& entry = entries[layerId];
+  uint32_t live = __atomic_load_n(&entry.published, __ATOMIC_ACQUIRE);
+  if ((live != CYCLE_NONE && (live >> 8) == key) || (entry.pending && entry.pendingKey == key)) {
+    return;
+  }
+
+  portENTER_CRITICAL(&requestLock);
+  entry.pendingKey = key;
+  entry.params = params;
+  entry.render = render;
+  entry.period = period;
+  entry.pending = true;
+  portEXIT_CRITICAL(&requestLock);
+
+  xTaskNotifyGive(compileTask);
+}
+
+bool cachedCycleFrame(int layerId, uint32_t key, int step, MotorFrame& frame) {
+  if (layerId >= CYCLE_ENTRIES) {
+    return false;
+  }
+
+  CycleEntry& entry = entries[layerId];
+  uint32_t live = __atomic_load_n(&entry.published, __ATOMIC_ACQUIRE);
+  if (live == CYCLE_NONE || (live >> 8) != key) {
+    return false;
+  }
+
+  uint8_t slot = live & 0xFF;
+  uint32_t seq = __atomic_load_n(&tableSeq[slot], __ATOMIC_ACQUIRE);
+  if (seq & 1) {
+    return false;
+  }
+  frame = tables[slot][step];
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&tableSeq[slot], __ATOMIC_RELAXED) == seq;
+}
@@ -0,0 +1,53 @@
+/*
+ * Smart Sheet - Cycle cache
+ * Periodic patterns (the wave repeats every NUM_MOTORS steps) are
+ * compiled once into a table of frames, so playback is a table index
+ * instead of recomputing every motor each step.
+ *
+ * Compilation runs in a low-priority task on core 0, away from loop().
+ * Each cached layer owns two frame tables: the task refills the one that
+ * is not published, then publishes it with a single atomic store of
+ * (key, table). Until a table for the current parameters is published,
+ * or when a lookup races a rewrite of its table, cachedCycleFrame()
+ * misses and the generator computes the step directly.
+ *
+ * Memory is a static pool of two tables per layer within the
+ * CYCLE_CACHE_BYTES budget (512 bytes for 4 layers of 8 motors). Layers
+ * beyond what the budget can hold are simply never cached.
+ */
+
+#ifndef SMARTSHEET_CYCLE_CACHE_H
+#define SMARTSHEET_CYCLE_CACHE_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "mixer.h"
+#include "patterns.h"
+
+// ==================== CACHE BUDGET ====================
+const int CYCLE_CACHE_BYTES = 8192;
+const int CYCLE_MAX_PERIOD = NUM_MOTORS;
+const int CYCLE_TABLE_BYTES = CYCLE_MAX_PERIOD * sizeof(MotorFrame);
+const int CYCLE_POOL_TABLES = CYCLE_CACHE_BYTES / CYCLE_TABLE_BYTES;
+const int CYCLE_ENTRIES = CYCLE_POOL_TABLES / 2 < MAX_LAYERS ? CYCLE_POOL_TABLES / 2 : MAX_LAYERS;
+
+// Renders one step of a periodic pattern from a snapshot of its layer
+typedef void (*CycleRenderer)(const PatternLayer& params, int step, MotorFrame& frame);
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initCycleCache();
+
+// Queues a compile unless a table for this key is already published or
+// pending; key must fit in 24 bits and capture everything that affects
+// the frames
+void requestCycleCompile(int layerId, uint32_t key, const PatternLayer& params,
+                         CycleRenderer render, int period);
+
+// Copies the given step into frame if a table with this key is live and
+// was not being rewritten during the copy
+bool cachedCycleFrame(int layerId, uint32_t key, int step, MotorFrame& frame);
+
+// Compiles every pending request; called by the compile task
+void compilePendingCycles();
+
+#endif
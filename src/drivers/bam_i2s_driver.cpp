@@ -0,0 +1,258 @@
+/*
+ * Smart Sheet - Bit-angle modulation driver (I2S parallel DMA)
+ * Register-level I2S0 LCD-mode setup, DMA descriptor chains and
+ * bit-plane buffer generation.
+ */
+
+#include "motor_driver.h"
+
+#if defined(MOTOR_DRIVER_BAM)
+#include "../bitplane.h"
+#include "driver/gpio.h"
+#include "driver/periph_ctrl.h"
+#include "rom/gpio.h"
+#include "rom/lldesc.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/i2s_struct.h"
+
+// ==================== TIMING ====================
+// Sample clock = 80 MHz / BAM_CLOCK_DIV / 2 (bit clock divider)
+#if defined(BAM_SHIFT_REGISTER)
+const int BAM_CLOCK_DIV = 4;                 // 10 MHz samples
+const int BAM_SHIFT_SAMPLES = 2 * BAM_REGISTER_BITS + 2;  // Clock low/high per bit, latch high/low
+const int BAM_UNIT_SAMPLES = 24;             // LSB display time, longer than a shift block
+const int BAM_ZERO_SAMPLES = 1024;           // Shared hold buffer
+const int BAM_MAX_DESCRIPTORS = 24;
+const uint16_t BAM_CLOCK_BIT = 1 << 8;
+const uint16_t BAM_LATCH_BIT = 1 << 9;
+#else
+const int BAM_CLOCK_DIV = 40;                // 1 MHz samples, ~3.9 kHz BAM period
+const int BAM_PERIOD_SAMPLES = 256;          // 255 weighted slots + 1 off slot
+const int BAM_MAX_DESCRIPTORS = 1;
+#endif
+
+// ==================== DMA BUFFERS ====================
+// Two buffer sets: DMA loops over the active one while commit() fills
+// the other. In 16-bit LCD mode the I2S FIFO emits samples in swapped
+// pairs, so every sample index is written as (i ^ 1).
+#if defined(BAM_SHIFT_REGISTER)
+DMA_ATTR static uint16_t shiftBlocks[2][BITPLANES][BAM_SHIFT_SAMPLES];
+DMA_ATTR static uint16_t zeroSamples[BAM_ZERO_SAMPLES];
+#else
+DMA_ATTR static uint16_t periodSamples[2][BAM_PERIOD_SAMPLES];
+#endif
+DMA_ATTR static lldesc_t descriptors[2][BAM_MAX_DESCRIPTORS];
+static int descriptorCount[2];
+
+static int activeSet = 0;
+static bool swapPending = false;
+
+uint8_t BamI2sDriver::frame[NUM_MOTORS];
+bool BamI2sDriver::dirty = false;
+
+// ==================== DESCRIPTOR CHAINS ====================
+static void linkDescriptor(int set, const void* buf, int bytes) {
+  lldesc_t& desc = descriptors[set][descriptorCount[set]++];
+  desc.size = bytes;
+  desc.length = bytes;
+  desc.offset = 0;
+  desc.sosf = 0;
+  desc.eof = 0;
+  desc.owner = 1;
+  desc.buf = (uint8_t*)buf;
+  desc.empty = 0;
+}
+
+// Chains the set's descriptors in order, the last one looping to the first
+static void closeChain(int set) {
+  int count = descriptorCount[set];
+  for (int i = 0; i < count; i++) {
+    descriptors[set][i].qe.stqe_next = &descriptors[set][(i + 1) % count];
+  }
+}
+
+static void buildChain(int set) {
+  descriptorCount[set] = 0;
+#if defined(BAM_SHIFT_REGISTER)
+  // Plane b is displayed from its latch until the next plane's latch:
+  // its hold plus the next shift block spans 2^b units
+  for (int b = 0; b < BITPLANES; b++) {
+    linkDescriptor(set, shiftBlocks[set][b], sizeof(shiftBlocks[set][b]));
+    int hold = (1 << b) * BAM_UNIT_SAMPLES - BAM_SHIFT_SAMPLES;
+    while (hold > 0) {
+      int chunk = hold < BAM_ZERO_SAMPLES ? hold : BAM_ZERO_SAMPLES;
+      linkDescriptor(set, zeroSamples, chunk * sizeof(uint16_t));
+      hold -= chunk;
+    }
+  }
+#else
+  linkDescriptor(set, periodSamples[set], sizeof(periodSamples[set]));
+#endif
+  closeChain(set);
+}
+
+// True once the DMA engine is walking the given set's descriptors
+static bool dmaOnSet(int set) {
+  uint32_t current = I2S0.out_link_dscr;
+  uint32_t first = (uint32_t)(uintptr_t)&descriptors[set][0];
+  uint32_t last = (uint32_t)(uintptr_t)&descriptors[set][descriptorCount[set] - 1];
+  return current >= first && current <= last;
+}
+
+// ==================== BIT-PLANE GENERATION ====================
+static void fillSet(int set, const uint8_t* frame) {
+#if defined(BAM_SHIFT_REGISTER)
+  // Per register: byte b = plane b, bit k = output Qk
+  uint64_t registerPlanes[BAM_LINES];
+  for (int line = 0; line < BAM_LINES; line++) {
+    registerPlanes[line] = transposeBits8x8(loadBytes8(frame + line * BAM_REGISTER_BITS, BAM_REGISTER_BITS));
+  }
+
+  for (int b = 0; b < BITPLANES; b++) {
+    // Gather plane b of every register, then transpose again so byte k
+    // holds bit k of every line: one sample word per shift position
+    uint64_t gathered = 0;
+    for (int line = 0; line < BAM_LINES; line++) {
+      gathered |= ((registerPlanes[line] >> (8 * b)) & 0xFF) << (8 * line);
+    }
+    uint64_t positions = transposeBits8x8(gathered);
+
+    // Qh is shifted in first
+    uint16_t* block = shiftBlocks[set][b];
+    for (int s = 0; s < BAM_REGISTER_BITS; s++) {
+      uint16_t data = (positions >> (8 * (BAM_REGISTER_BITS - 1 - s))) & 0xFF;
+      block[(2 * s) ^ 1] = data;
+      block[(2 * s + 1) ^ 1] = data | BAM_CLOCK_BIT;
+    }
+    block[(2 * BAM_REGISTER_BITS) ^ 1] = BAM_LATCH_BIT;
+    block[(2 * BAM_REGISTER_BITS + 1) ^ 1] = 0;
+  }
+#else
+  uint16_t planes[BITPLANES];
+  packBitplanes16(frame, NUM_MOTORS, planes);
+
+  uint16_t* out = periodSamples[set];
+  int pos = 0;
+  for (int b = 0; b < BITPLANES; b++) {
+    for (int n = 0; n < (1 << b); n++) {
+      out[(pos++) ^ 1] = planes[b];
+    }
+  }
+  out[pos ^ 1] = 0; // Off slot pads the period to an even sample count
+#endif
+}
+
+// ==================== I2S SETUP ====================
+static void routePin(int pin, int bit) {
+  gpio_pad_select_gpio(pin);
+  gpio_set_direction((gpio_num_t)pin, GPIO_MODE_OUTPUT);
+  gpio_matrix_out(pin, I2S0O_DATA_OUT8_IDX + bit, false, false); // 16-bit LCD mode uses OUT8..OUT23
+}
+
+static void startI2s(lldesc_t* first) {
+  periph_module_enable(PERIPH_I2S0_MODULE);
+
+  I2S0.conf.tx_reset = 1;
+  I2S0.conf.tx_reset = 0;
+  I2S0.conf.tx_fifo_reset = 1;
+  I2S0.conf.tx_fifo_reset = 0;
+  I2S0.lc_conf.out_rst = 1;
+  I2S0.lc_conf.out_rst = 0;
+  I2S0.lc_conf.ahbm_rst = 1;
+  I2S0.lc_conf.ahbm_rst = 0;
+
+  // LCD (parallel) master mode, 16-bit samples, no PCM processing
+  I2S0.conf2.val = 0;
+  I2S0.conf2.lcd_en = 1;
+  I2S0.conf1.val = 0;
+  I2S0.conf1.tx_pcm_bypass = 1;
+  I2S0.conf_chan.val = 0;
+  I2S0.conf_chan.tx_chan_mod = 1;
+  I2S0.fifo_conf.val = 0;
+  I2S0.fifo_conf.tx_fifo_mod = 1;
+  I2S0.fifo_conf.tx_fifo_mod_force_en = 1;
+  I2S0.fifo_conf.tx_data_num = 32;
+  I2S0.fifo_conf.dscr_en = 1;
+  I2S0.sample_rate_conf.val = 0;
+  I2S0.sample_rate_conf.tx_bits_mod = 16;
+  I2S0.sample_rate_conf.tx_bck_div_num = 2;
+  I2S0.clkm_conf.val = 0;
+  I2S0.clkm_conf.clka_en = 0;
+  I2S0.clkm_conf.clkm_div_a = 1;
+  I2S0.clkm_conf.clkm_div_b = 0;
+  I2S0.clkm_conf.clkm_div_num = BAM_CLOCK_DIV;
+  I2S0.timing.val = 0;
+  I2S0.int_ena.val = 0;
+
+  I2S0.lc_conf.val = 0;
+  I2S0.lc_conf.outdscr_burst_en = 1;
+  I2S0.lc_conf.out_data_burst_en = 1;
+
+  I2S0.out_link.addr = (uint32_t)(uintptr_t)first;
+  I2S0.out_link.start = 1;
+  I2S0.conf.tx_start = 1;
+}
+
+// ==================== PUBLIC API ====================
+void BamI2sDriver::begin() {
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    frame[i] = 0;
+  }
+
+  for (int line = 0; line < BAM_LINES; line++) {
+    routePin(BAM_LINE_PINS[line], line);
+  }
+#if defined(BAM_SHIFT_REGISTER)
+  routePin(BAM_CLOCK_PIN, 8);
+  routePin(BAM_LATCH_PIN, 9);
+  memset(zeroSamples, 0, sizeof(zeroSamples));
+#endif
+
+  for (int set = 0; set < 2; set++) {
+    fillSet(set, frame);
+    buildChain(set);
+  }
+  activeSet = 0;
+  swapPending = false;
+  dirty = false;
+
+  startI2s(&descriptors[activeSet][0]);
+
+  Serial.printf("BAM: %d motors on %d I2S data lines, %s\n", NUM_MOTORS, BAM_LINES,
+#if defined(BAM_SHIFT_REGISTER)
+                "74HC595 chains"
+#else
+                "parallel gates"
+#endif
+                );
+}
+
+void BamI2sDriver::commit() {
+  if (!dirty) {
+    return;
+  }
+
+  // The idle set is only safe to rewrite once DMA has left it
+  if (swapPending) {
+    if (!dmaOnSet(activeSet)) {
+      return;
+    }
+    swapPending = false;
+  }
+
+  int idle = activeSet ^ 1;
+  fillSet(idle, frame);
+
+  // Relink: the active chain's tail now continues into the idle chain,
+  // which loops on itself. DMA switches at the end of the current period.
+  int idleLast = descriptorCount[idle] - 1;
+  int activeLast = descriptorCount[activeSet] - 1;
+  descriptors[idle][idleLast].qe.stqe_next = &descriptors[idle][0];
+  descriptors[activeSet][activeLast].qe.stqe_next = &descriptors[idle][0];
+
+  activeSet = idle;
+  swapPending = true;
+  dirty = false;
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * Smart Sheet - Bit-angle modulation driver (I2S parallel DMA)
+ * Streams bit-planes of the motor frame out of I2S0 in LCD (parallel)
+ * mode. DMA loops over the current frame's sample buffers continuously,
+ * so the CPU only works when a frame changes: commit() repacks the
+ * bit-planes into the idle buffer set and relinks the DMA chain to it.
+ *
+ * Bit-angle modulation shows plane b for 2^b time units, giving 8-bit
+ * resolution with only 8 output changes per period.
+ *
+ * Two wirings are supported:
+ *   parallel (default)       - each data line gates one motor (up to 16)
+ *   -D BAM_SHIFT_REGISTER    - each data line feeds a 74HC595, with shared
+ *                              shift clock and latch lines (up to 64 motors)
+ *
+ * In shift-register mode each plane is shifted in while the previous one
+ * is displayed, and only the short shift block is rebuilt per frame; the
+ * hold time between latches streams from one shared all-zero buffer.
+ */
+
+#ifndef SMARTSHEET_BAM_I2S_DRIVER_H
+#define SMARTSHEET_BAM_I2S_DRIVER_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+struct BamI2sDriver {
+#if defined(BAM_SHIFT_REGISTER)
+  static_assert(BAM_LINES <= 8, "Shift-register BAM supports up to 8 data lines");
+#else
+  static_assert(NUM_MOTORS <= 16, "Parallel BAM supports up to 16 data lines");
+#endif
+
+  static const char* name() { return "BAM"; }
+
+  static void begin();
+
+  static inline void write(int motor, uint8_t duty) {
+    if (frame[motor] != duty) {
+      frame[motor] = duty;
+      dirty = true;
+    }
+  }
+
+  // Repacks and swaps buffers only when the frame changed. If the DMA has
+  // not yet picked up the previous swap, the frame stays dirty and is
+  // retried on the next commit.
+  static void commit();
+
+  static uint8_t frame[NUM_MOTORS];
+  static bool dirty;
+};
+
+#endif
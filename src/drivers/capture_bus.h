@@ -0,0 +1,53 @@
+/*
+ * Smart Sheet - Capturing I2C bus stand-in
+ * Records every burst in memory instead of touching hardware, so the
+ * expander driver's byte streams can be inspected off-target. Native
+ * PCA9685 builds use it as the bus (see test/test_pca9685); once
+ * CAPTURE_BUS_MAX_BURSTS are held it refuses more until clear().
+ */
+
+#ifndef SMARTSHEET_CAPTURE_BUS_H
+#define SMARTSHEET_CAPTURE_BUS_H
+
+#include <string.h>
+#include "i2c_bus.h"
+
+const int CAPTURE_BUS_MAX_BURSTS = 64;
+
+struct CaptureBus {
+  static inline I2cBurst bursts[CAPTURE_BUS_MAX_BURSTS];
+  static inline int count = 0;
+  static inline bool full = false;     // Simulates a full TX queue
+
+  static void begin(int sdaPin, int sclPin, uint32_t clockHz) {
+    (void)sdaPin;
+    (void)sclPin;
+    (void)clockHz;
+    clear();
+    full = false;
+  }
+
+  static void clear() {
+    count = 0;
+  }
+
+  static bool writeSync(uint8_t address, const uint8_t* data, uint8_t length) {
+    I2cBurst burst;
+    burst.address = address;
+    burst.length = length;
+    memcpy(burst.data, data, length);
+    return submit(burst);
+  }
+
+  static bool submit(const I2cBurst& burst) {
+    if (full || count >= CAPTURE_BUS_MAX_BURSTS) {
+      return false;
+    }
+    bursts[count++] = burst;
+    return true;
+  }
+
+  static uint32_t errorCount() { return 0; }
+};
+
+#endif
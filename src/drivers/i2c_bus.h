@@ -0,0 +1,21 @@
+/*
+ * Smart Sheet - I2C burst transport
+ * A burst is one complete I2C write transaction: device address plus the
+ * bytes that follow it (register pointer first for auto-increment devices).
+ */
+
+#ifndef SMARTSHEET_I2C_BUS_H
+#define SMARTSHEET_I2C_BUS_H
+
+#include <stdint.h>
+
+// Largest burst: register pointer + one PCA9685's full 16-channel image
+const int I2C_BURST_MAX = 1 + 16 * 4;
+
+struct I2cBurst {
+  uint8_t address;
+  uint8_t length;
+  uint8_t data[I2C_BURST_MAX];
+};
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Smart Sheet - LEDC motor driver
+ * Default backend: one LEDC PWM channel per motor, spread across both
+ * LEDC speed groups by Motors::ledcChannel()
+ */
+
+#ifndef SMARTSHEET_LEDC_DRIVER_H
+#define SMARTSHEET_LEDC_DRIVER_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+struct LedcDriver {
+  static_assert(NUM_MOTORS <= LEDC_CHANNELS, "ESP32 LEDC has only 16 channels");
+
+  static const char* name() { return "LEDC"; }
+
+  static void begin() {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      int channel = Motors::ledcChannel(i);
+      ledcSetup(channel, PWM_FREQUENCY, PWM_RESOLUTION);
+      ledcAttachPin(MOTOR_PINS[i], channel);
+      ledcWrite(channel, 0); // Start with motors off
+      Serial.printf("Motor %d initialized on GPIO %d (PWM Channel %d)\n", 
+                    i + 1, MOTOR_PINS[i], channel);
+    }
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    ledcWrite(Motors::ledcChannel(motor), duty);
+  }
+
+  // LEDC latches each write at the next PWM period, nothing to flush
+  static inline void commit() {}
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Smart Sheet - MCPWM motor driver
+ * Drives motors from the two MCPWM units (3 timers x 2 outputs each).
+ * All timers are synchronised to timer 0 of their unit so every motor's
+ * PWM period starts on the same edge, and duty updates are latched at
+ * the timer zero point.
+ */
+
+#ifndef SMARTSHEET_MCPWM_DRIVER_H
+#define SMARTSHEET_MCPWM_DRIVER_H
+
+#include <Arduino.h>
+#include "driver/mcpwm.h"
+#include "../config.h"
+
+const int MCPWM_OUTPUTS_PER_UNIT = 6;
+
+struct McpwmDriver {
+  static_assert(NUM_MOTORS <= 2 * MCPWM_OUTPUTS_PER_UNIT, "ESP32 has only 12 MCPWM outputs");
+
+  static const char* name() { return "MCPWM"; }
+
+  static inline mcpwm_unit_t unitOf(int motor) {
+    return (mcpwm_unit_t)(motor / MCPWM_OUTPUTS_PER_UNIT);
+  }
+
+  static inline mcpwm_timer_t timerOf(int motor) {
+    return (mcpwm_timer_t)((motor % MCPWM_OUTPUTS_PER_UNIT) / 2);
+  }
+
+  static inline mcpwm_generator_t generatorOf(int motor) {
+    return (mcpwm_generator_t)(motor % 2);
+  }
+
+  static void begin() {
+    mcpwm_config_t config;
+    config.frequency = PWM_FREQUENCY;
+    config.cmpr_a = 0;
+    config.cmpr_b = 0;
+    config.counter_mode = MCPWM_UP_COUNTER;
+    config.duty_mode = MCPWM_DUTY_MODE_0;
+
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      int output = i % MCPWM_OUTPUTS_PER_UNIT;
+      mcpwm_gpio_init(unitOf(i), (mcpwm_io_signals_t)(MCPWM0A + output), MOTOR_PINS[i]);
+      if (output % 2 == 0) {
+        mcpwm_init(unitOf(i), timerOf(i), &config);
+      }
+      Serial.printf("Motor %d initialized on GPIO %d (MCPWM%d Timer %d%c)\n", 
+                    i + 1, MOTOR_PINS[i], unitOf(i), timerOf(i),
+                    generatorOf(i) == MCPWM_GEN_A ? 'A' : 'B');
+    }
+
+    // Timer 0 of each unit emits a sync pulse at zero, the others follow it
+    mcpwm_sync_config_t sync;
+    sync.sync_sig = MCPWM_SELECT_TIMER0_SYNC;
+    sync.timer_val = 0;
+    sync.count_direction = MCPWM_TIMER_DIRECTION_UP;
+    for (int i = 0; i < NUM_MOTORS; i += 2) {
+      if (timerOf(i) == MCPWM_TIMER_0) {
+        mcpwm_set_timer_sync_output(unitOf(i), MCPWM_TIMER_0, MCPWM_SWSYNC_SOURCE_TEZ);
+      } else {
+        mcpwm_sync_configure(unitOf(i), timerOf(i), &sync);
+      }
+    }
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    mcpwm_set_duty(unitOf(motor), timerOf(motor), generatorOf(motor),
+                   duty * (100.0f / PWM_MAX_DUTY));
+  }
+
+  // Comparators are shadowed and latch at timer zero, nothing to flush
+  static inline void commit() {}
+};
+
+#endif
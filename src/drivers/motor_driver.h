@@ -0,0 +1,51 @@
+/*
+ * Smart Sheet - Motor driver selection
+ * The output backend is chosen at compile time from build flags, so the
+ * commit path calls the driver's static inline functions directly with
+ * no virtual dispatch.
+ *
+ * Every driver provides:
+ *   static const char* name();
+ *   static void begin();                         - configure outputs, all off
+ *   static void write(int motor, uint8_t duty);  - stage one motor's duty
+ *   static void commit();                        - flush staged duties
+ *
+ * Select with one of -D MOTOR_DRIVER_SDM, -D MOTOR_DRIVER_MCPWM,
+ * -D MOTOR_DRIVER_PCA9685, -D MOTOR_DRIVER_BAM, -D MOTOR_DRIVER_SIM or
+ * -D MOTOR_DRIVER_STUB; LEDC is the default. A native PCA9685 build writes
+ * into CaptureBus instead of the I2C peripheral.
+ */
+
+#ifndef SMARTSHEET_MOTOR_DRIVER_H
+#define SMARTSHEET_MOTOR_DRIVER_H
+
+#if defined(MOTOR_DRIVER_SDM)
+#include "sdm_driver.h"
+typedef SdmDriver MotorDriver;
+#elif defined(MOTOR_DRIVER_MCPWM)
+#include "mcpwm_driver.h"
+typedef McpwmDriver MotorDriver;
+#elif defined(MOTOR_DRIVER_PCA9685)
+#include "pca9685_driver.h"
+#if defined(NATIVE_BUILD)
+#include "capture_bus.h"
+typedef Pca9685Driver<CaptureBus> MotorDriver;
+#else
+#include "wire_async_bus.h"
+typedef Pca9685Driver<WireAsyncBus> MotorDriver;
+#endif
+#elif defined(MOTOR_DRIVER_BAM)
+#include "bam_i2s_driver.h"
+typedef BamI2sDriver MotorDriver;
+#elif defined(MOTOR_DRIVER_SIM)
+#include "sim_driver.h"
+typedef SimDriver MotorDriver;
+#elif defined(MOTOR_DRIVER_STUB)
+#include "stub_driver.h"
+typedef StubDriver MotorDriver;
+#else
+#include "ledc_driver.h"
+typedef LedcDriver MotorDriver;
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Smart Sheet - PCA9685 I2C PWM expander driver
+ * Drives 16 motors per PCA9685, chained at consecutive I2C addresses.
+ *
+ * write() only updates a shadow copy of each chip's LED register block
+ * and marks changed channels dirty. commit() turns each chip's dirty set
+ * into as few contiguous ranges as possible (short clean gaps are resent
+ * rather than starting a new transaction) and submits each range as one
+ * auto-increment burst. Only channels that actually changed cost bus time.
+ *
+ * The bus is a template parameter: WireAsyncBus on the ESP32, CaptureBus
+ * off-target to inspect the generated byte streams.
+ */
+
+#ifndef SMARTSHEET_PCA9685_DRIVER_H
+#define SMARTSHEET_PCA9685_DRIVER_H
+
+#include <Arduino.h>
+#include <string.h>
+#include "../config.h"
+#include "i2c_bus.h"
+
+// ==================== PCA9685 REGISTERS ====================
+const uint8_t PCA9685_MODE1 = 0x00;
+const uint8_t PCA9685_MODE2 = 0x01;
+const uint8_t PCA9685_LED0_ON_L = 0x06;
+const uint8_t PCA9685_PRE_SCALE = 0xFE;
+
+const uint8_t PCA9685_MODE1_RESTART = 0x80;
+const uint8_t PCA9685_MODE1_AI = 0x20;      // Register auto-increment
+const uint8_t PCA9685_MODE1_SLEEP = 0x10;
+const uint8_t PCA9685_MODE2_OUTDRV = 0x04;  // Totem-pole outputs
+const uint8_t PCA9685_FULL_BIT = 0x10;      // Bit 4 of ON_H / OFF_H
+
+const uint32_t PCA9685_OSC_HZ = 25000000;
+const int PCA9685_REGS_PER_CHANNEL = 4;
+
+// Resending up to this many clean channels is cheaper than a new burst
+// (START + address + register pointer)
+const int PCA9685_MERGE_GAP = 1;
+
+template <typename Bus>
+struct Pca9685Driver {
+  static_assert(NUM_MOTORS <= PCA9685_CHIPS * PCA9685_CHANNELS, "Not enough PCA9685 channels for the motor bank");
+
+  static const int CHIPS = (NUM_MOTORS + PCA9685_CHANNELS - 1) / PCA9685_CHANNELS;
+
+  static inline uint8_t shadow[CHIPS][PCA9685_CHANNELS * PCA9685_REGS_PER_CHANNEL];
+  static inline uint16_t dirty[CHIPS];
+
+  static const char* name() { return "PCA9685"; }
+
+  static void begin() {
+    Bus::begin(PCA9685_SDA_PIN, PCA9685_SCL_PIN, PCA9685_I2C_HZ);
+
+    uint8_t prescale = (PCA9685_OSC_HZ + 2048 * PCA9685_PWM_FREQUENCY) /
+                       (4096 * PCA9685_PWM_FREQUENCY) - 1;
+
+    for (int chip = 0; chip < CHIPS; chip++) {
+      uint8_t address = PCA9685_BASE_ADDRESS + chip;
+
+      // Prescaler can only be written while the oscillator sleeps
+      writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_SLEEP | PCA9685_MODE1_AI);
+      writeRegister(address, PCA9685_PRE_SCALE, prescale);
+      writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_AI);
+      delayMicroseconds(500); // Oscillator start-up
+      writeRegister(address, PCA9685_MODE1, PCA9685_MODE1_RESTART | PCA9685_MODE1_AI);
+      writeRegister(address, PCA9685_MODE2, PCA9685_MODE2_OUTDRV);
+
+      // Start with motors off, sent synchronously as one burst
+      for (int ch = 0; ch < PCA9685_CHANNELS; ch++) {
+        encode(ch, 0, &shadow[chip][ch * PCA9685_REGS_PER_CHANNEL]);
+      }
+      dirty[chip] = 0;
+
+      uint8_t data[I2C_BURST_MAX];
+      data[0] = PCA9685_LED0_ON_L;
+      memcpy(data + 1, shadow[chip], sizeof(shadow[chip]));
+      Bus::writeSync(address, data, sizeof(data));
+
+      int last = (chip + 1) * PCA9685_CHANNELS;
+      Serial.printf("PCA9685 #%d initialized at 0x%02X (motors %d-%d)\n", 
+                    chip, address, chip * PCA9685_CHANNELS + 1,
+                    last < NUM_MOTORS ? last : NUM_MOTORS);
+    }
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    int chip = motor / PCA9685_CHANNELS;
+    int channel = motor % PCA9685_CHANNELS;
+    uint8_t regs[PCA9685_REGS_PER_CHANNEL];
+    encode(channel, duty, regs);
+
+    uint8_t* slot = &shadow[chip][channel * PCA9685_REGS_PER_CHANNEL];
+    if (memcmp(slot, regs, PCA9685_REGS_PER_CHANNEL) != 0) {
+      memcpy(slot, regs, PCA9685_REGS_PER_CHANNEL);
+      dirty[chip] |= 1 << channel;
+    }
+  }
+
+  static void commit() {
+    for (int chip = 0; chip < CHIPS; chip++) {
+      uint16_t mask = dirty[chip];
+      int lo = nextDirty(mask, 0);
+      while (lo < PCA9685_CHANNELS) {
+        int hi = lo;
+        int next = nextDirty(mask, hi + 1);
+        while (next < PCA9685_CHANNELS && next - hi - 1 <= PCA9685_MERGE_GAP) {
+          hi = next;
+          next = nextDirty(mask, hi + 1);
+        }
+
+        if (!sendRange(chip, lo, hi)) {
+          return; // Queue full, remaining ranges stay dirty for next frame
+        }
+        dirty[chip] &= ~(uint16_t)(((1u << (hi + 1)) - 1) & ~((1u << lo) - 1));
+        lo = next;
+      }
+    }
+  }
+
+private:
+  // 8-bit duty -> LEDn_ON/OFF. ON times are staggered per channel so the
+  // motors on one chip do not all switch on the same edge.
+  static inline void encode(int channel, uint8_t duty, uint8_t* regs) {
+    uint16_t on = (channel << 8) & 0x0FFF;
+    if (duty == 0) {
+      regs[0] = 0; regs[1] = 0; regs[2] = 0; regs[3] = PCA9685_FULL_BIT;
+    } else if (duty == PWM_MAX_DUTY) {
+      regs[0] = 0; regs[1] = PCA9685_FULL_BIT; regs[2] = 0; regs[3] = 0;
+    } else {
+      uint16_t width = ((uint16_t)duty << 4) | (duty >> 4);  // 0-255 -> 0-4095
+      uint16_t off = (on + width) & 0x0FFF;
+      regs[0] = on & 0xFF; regs[1] = on >> 8;
+      regs[2] = off & 0xFF; regs[3] = off >> 8;
+    }
+  }
+
+  static inline int nextDirty(uint16_t mask, int from) {
+    uint32_t rest = from < PCA9685_CHANNELS ? (uint32_t)mask >> from : 0;
+    return rest ? from + __builtin_ctz(rest) : PCA9685_CHANNELS;
+  }
+
+  static bool sendRange(int chip, int lo, int hi) {
+    I2cBurst burst;
+    int bytes = (hi - lo + 1) * PCA9685_REGS_PER_CHANNEL;
+    burst.address = PCA9685_BASE_ADDRESS + chip;
+    burst.length = 1 + bytes;
+    burst.data[0] = PCA9685_LED0_ON_L + lo * PCA9685_REGS_PER_CHANNEL;
+    memcpy(burst.data + 1, &shadow[chip][lo * PCA9685_REGS_PER_CHANNEL], bytes);
+    return Bus::submit(burst);
+  }
+
+  static void writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    uint8_t data[2] = {reg, value};
+    Bus::writeSync(address, data, sizeof(data));
+  }
+};
+
+#endif
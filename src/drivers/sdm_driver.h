@@ -0,0 +1,39 @@
+/*
+ * Smart Sheet - Sigma-delta motor driver
+ * Drives each motor from one of the ESP32's 8 sigma-delta modulator
+ * channels. The pulse density output has no fixed PWM period, so there is
+ * no audible carrier tone from the motors or MOSFETs.
+ */
+
+#ifndef SMARTSHEET_SDM_DRIVER_H
+#define SMARTSHEET_SDM_DRIVER_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+const uint32_t SDM_FREQUENCY = 312500;   // Modulator clock, 80 MHz / 256
+
+struct SdmDriver {
+  static_assert(NUM_MOTORS <= 8, "ESP32 has only 8 sigma-delta channels");
+
+  static const char* name() { return "SDM"; }
+
+  static void begin() {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      sigmaDeltaSetup(i, SDM_FREQUENCY);
+      sigmaDeltaAttachPin(MOTOR_PINS[i], i);
+      sigmaDeltaWrite(i, 0); // Start with motors off
+      Serial.printf("Motor %d initialized on GPIO %d (SDM Channel %d)\n", 
+                    i + 1, MOTOR_PINS[i], i);
+    }
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    sigmaDeltaWrite(motor, duty);
+  }
+
+  // Density changes take effect immediately, nothing to flush
+  static inline void commit() {}
+};
+
+#endif
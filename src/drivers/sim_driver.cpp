@@ -0,0 +1,10 @@
+/*
+ * Smart Sheet - Simulator motor driver storage
+ */
+
+#include "motor_driver.h"
+
+#if defined(MOTOR_DRIVER_SIM)
+uint8_t SimDriver::staged[NUM_MOTORS];
+uint8_t SimDriver::duties[NUM_MOTORS];
+#endif
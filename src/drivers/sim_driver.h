@@ -0,0 +1,42 @@
+/*
+ * Smart Sheet - Simulator motor driver
+ * Stands in for the LEDC channels in the firmware simulator: staged
+ * duties take effect on commit, and every change is timestamped on the
+ * simulated clock into the duty trace (hal/sim/trace.h).
+ */
+
+#ifndef SMARTSHEET_SIM_DRIVER_H
+#define SMARTSHEET_SIM_DRIVER_H
+
+#include <stdint.h>
+#include "../config.h"
+#include "../hal/sim/trace.h"
+
+struct SimDriver {
+  static uint8_t staged[NUM_MOTORS];
+  static uint8_t duties[NUM_MOTORS];         // As last committed
+
+  static const char* name() { return "SIM"; }
+
+  static void begin() {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      staged[i] = 0;
+      duties[i] = 0;
+    }
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    staged[motor] = duty;
+  }
+
+  static inline void commit() {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      if (staged[i] != duties[i]) {
+        duties[i] = staged[i];
+        traceDuty(i, duties[i]);
+      }
+    }
+  }
+};
+
+#endif
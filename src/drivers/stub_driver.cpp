@@ -0,0 +1,11 @@
+/*
+ * Smart Sheet - Host stub motor driver storage
+ */
+
+#include "motor_driver.h"
+
+#if defined(MOTOR_DRIVER_STUB)
+uint8_t StubDriver::duties[NUM_MOTORS];
+uint32_t StubDriver::writes = 0;
+uint32_t StubDriver::commits = 0;
+#endif
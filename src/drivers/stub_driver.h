@@ -0,0 +1,38 @@
+/*
+ * Smart Sheet - Host stub motor driver
+ * Records duties in memory instead of touching hardware, so the pattern
+ * and commit path can run off-target.
+ */
+
+#ifndef SMARTSHEET_STUB_DRIVER_H
+#define SMARTSHEET_STUB_DRIVER_H
+
+#include <stdint.h>
+#include "../config.h"
+
+struct StubDriver {
+  static uint8_t duties[NUM_MOTORS];
+  static uint32_t writes;
+  static uint32_t commits;
+
+  static const char* name() { return "STUB"; }
+
+  static void begin() {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      duties[i] = 0;
+    }
+    writes = 0;
+    commits = 0;
+  }
+
+  static inline void write(int motor, uint8_t duty) {
+    duties[motor] = duty;
+    writes++;
+  }
+
+  static inline void commit() {
+    commits++;
+  }
+};
+
+#endif
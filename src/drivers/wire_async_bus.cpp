@@ -0,0 +1,65 @@
+/*
+ * Smart Sheet - Asynchronous Wire bus
+ */
+
+#include "motor_driver.h"
+
+#if defined(MOTOR_DRIVER_PCA9685) && !defined(NATIVE_BUILD)
+#include <Wire.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+// ==================== BUS STATE ====================
+static QueueHandle_t burstQueue = NULL;
+static volatile uint32_t busErrors = 0;
+
+// ==================== TX TASK ====================
+static void busTask(void* param) {
+  (void)param;
+  I2cBurst burst;
+  for (;;) {
+    if (xQueueReceive(burstQueue, &burst, portMAX_DELAY) == pdTRUE) {
+      Wire.beginTransmission(burst.address);
+      Wire.write(burst.data, burst.length);
+      if (Wire.endTransmission() != 0) {
+        busErrors++;
+      }
+    }
+  }
+}
+
+// ==================== PUBLIC API ====================
+// Queue and task are created here, during setup, so the commit path never
+// allocates. The task sits on the empty queue until the first submit().
+void WireAsyncBus::begin(int sdaPin, int sclPin, uint32_t clockHz) {
+  Wire.begin(sdaPin, sclPin, clockHz);
+  if (burstQueue == NULL) {
+    burstQueue = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2cBurst));
+    xTaskCreatePinnedToCore(busTask, "i2c_tx", I2C_TASK_STACK, NULL,
+                            I2C_TASK_PRIORITY, NULL, I2C_TASK_CORE);
+  }
+}
+
+bool WireAsyncBus::writeSync(uint8_t address, const uint8_t* data, uint8_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(data, length);
+  bool ok = Wire.endTransmission() == 0;
+  if (!ok) {
+    busErrors++;
+  }
+  return ok;
+}
+
+bool WireAsyncBus::submit(const I2cBurst& burst) {
+  if (burstQueue == NULL) {
+    return false;
+  }
+  return xQueueSendToBack(burstQueue, &burst, 0) == pdTRUE;
+}
+
+uint32_t WireAsyncBus::errorCount() {
+  return busErrors;
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Smart Sheet - Asynchronous Wire bus
+ * Bursts are queued from the commit path and written by a dedicated
+ * FreeRTOS task, so loop() never waits on the I2C bus. If the queue is
+ * full, submit() fails immediately and the caller keeps the data dirty
+ * for the next frame.
+ */
+
+#ifndef SMARTSHEET_WIRE_ASYNC_BUS_H
+#define SMARTSHEET_WIRE_ASYNC_BUS_H
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+
+const int I2C_QUEUE_DEPTH = 16;
+const int I2C_TASK_STACK = 3072;
+const int I2C_TASK_PRIORITY = 5;
+const int I2C_TASK_CORE = 0;           // loop() runs on core 1
+
+struct WireAsyncBus {
+  static void begin(int sdaPin, int sclPin, uint32_t clockHz);
+
+  // Blocking write, only for setup before the first submit()
+  static bool writeSync(uint8_t address, const uint8_t* data, uint8_t length);
+
+  // Non-blocking enqueue from the commit path
+  static bool submit(const I2cBurst& burst);
+
+  static uint32_t errorCount();
+};
+
+#endif
@@ -0,0 +1,402 @@
+/*
+ * Smart Sheet - Pattern expressions
+ * Recursive-descent compiler and Q16.16 stack interpreter
+ */
+
+#include "expr.h"
+
+const int32_t Q16_ONE = 1 << 16;
+const int32_t Q16_INV_TWO_PI = 10430;      // 65536 / (2 * PI)
+const int32_t Q16_HALF_PI = 102944;
+const int SINE_TABLE_BITS = 8;
+const int SINE_TABLE_SIZE = 1 << SINE_TABLE_BITS;
+
+// ==================== GLOBAL VARIABLES ====================
+ExprProgram activeExpression = {{EXPR_END}, 1, 0};
+unsigned long expressionStartTime = 0;
+
+// One full turn of sine in Q16.16, plus a guard entry for interpolation
+static int32_t sineTable[SINE_TABLE_SIZE + 1];
+static bool sineReady = false;
+
+// ==================== FIXED-POINT MATH ====================
+static void initSineTable() {
+  for (int k = 0; k <= SINE_TABLE_SIZE; k++) {
+    sineTable[k] = (int32_t)lround(sin(k * 2 * PI / SINE_TABLE_SIZE) * Q16_ONE);
+  }
+  sineReady = true;
+}
+
+// Results are worked out in 64 bits and pinned to the Q16.16 range, so
+// overflow saturates instead of wrapping (or being undefined for + and -)
+static inline int32_t q16Saturate(int64_t x) {
+  return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+static inline int32_t q16Add(int32_t a, int32_t b) {
+  return q16Saturate((int64_t)a + b);
+}
+
+static inline int32_t q16Sub(int32_t a, int32_t b) {
+  return q16Saturate((int64_t)a - b);
+}
+
+static inline int32_t q16Neg(int32_t a) {
+  return q16Saturate(-(int64_t)a);
+}
+
+static inline int32_t q16Abs(int32_t a) {
+  return a < 0 ? q16Neg(a) : a;
+}
+
+static inline int32_t q16Mul(int32_t a, int32_t b) {
+  return q16Saturate(((int64_t)a * b) >> 16);
+}
+
+static inline int32_t q16Div(int32_t a, int32_t b) {
+  if (b == 0) {
+    return 0;
+  }
+  return q16Saturate((int64_t)a * Q16_ONE / b);
+}
+
+// INT_MIN % -1 traps like a division overflow; the result is 0 anyway
+static inline int32_t q16Mod(int32_t a, int32_t b) {
+  if (b == 0 || b == -1) {
+    return 0;
+  }
+  return a % b;
+}
+
+// sin of an angle in radians: turns = x / 2pi, the top bits of the
+// fractional turn index the table, the rest interpolate
+static inline int32_t q16Sin(int32_t x) {
+  uint32_t turns = (uint32_t)q16Mul(x, Q16_INV_TWO_PI) & 0xFFFF;
+  uint32_t index = turns >> (16 - SINE_TABLE_BITS);
+  int32_t fraction = turns & ((1 << (16 - SINE_TABLE_BITS)) - 1);
+  int32_t a = sineTable[index];
+  int32_t b = sineTable[index + 1];
+  return a + (((b - a) * fraction) >> (16 - SINE_TABLE_BITS));
+}
+
+// ==================== COMPILER ====================
+struct ExprCompiler {
+  const char* source;
+  const char* pos;
+  ExprProgram* program;
+  int depth;                               // Current stack depth
+  int nesting;
+  ExprError error;
+  int constAt[EXPR_MAX_STACK + 1];         // Code offset of each stack slot's constant, -1 if computed
+};
+
+static void fail(ExprCompiler& c, ExprError error) {
+  if (c.error == EXPR_OK) {
+    c.error = error;
+  }
+}
+
+static void skipSpaces(ExprCompiler& c) {
+  while (*c.pos == ' ') {
+    c.pos++;
+  }
+}
+
+static void emitByte(ExprCompiler& c, uint8_t byte) {
+  if (c.program->length >= EXPR_MAX_CODE) {
+    fail(c, EXPR_ERR_TOO_LONG);
+    return;
+  }
+  c.program->code[c.program->length++] = byte;
+}
+
+// Pushes one slot holding the constant at `offset`, or a computed value
+static void pushSlot(ExprCompiler& c, int offset) {
+  if (c.depth >= EXPR_MAX_STACK) {
+    fail(c, EXPR_ERR_STACK);
+    return;
+  }
+  c.constAt[c.depth++] = offset;
+  if (c.depth > c.program->maxStack) {
+    c.program->maxStack = c.depth;
+  }
+}
+
+static void emitConst(ExprCompiler& c, int32_t value) {
+  int at = c.program->length;
+  emitByte(c, EXPR_CONST);
+  for (int b = 0; b < 4; b++) {
+    emitByte(c, (value >> (8 * b)) & 0xFF);
+  }
+  pushSlot(c, at);
+}
+
+static int32_t readConst(const uint8_t* code) {
+  return (int32_t)((uint32_t)code[0] | ((uint32_t)code[1] << 8) |
+                   ((uint32_t)code[2] << 16) | ((uint32_t)code[3] << 24));
+}
+
+static void emitLoad(ExprCompiler& c, ExprOp op) {
+  emitByte(c, op);
+  pushSlot(c, -1);
+}
+
+static int32_t applyOp(ExprOp op, int32_t a, int32_t b);
+
+// Emits an operator taking `arity` operands; folds it into a constant
+// when every operand is a constant. An operand's code directly follows
+// the one below it, so constant operands are always the last bytes emitted.
+static void emitOp(ExprCompiler& c, ExprOp op, int arity) {
+  if (c.error != EXPR_OK || c.depth < arity) {
+    fail(c, EXPR_ERR_SYNTAX);
+    return;
+  }
+
+  int base = c.depth - arity;
+  bool fold = true;
+  for (int k = base; k < c.depth; k++) {
+    fold = fold && c.constAt[k] >= 0;
+  }
+
+  if (fold) {
+    int32_t a = readConst(&c.program->code[c.constAt[base] + 1]);
+    int32_t b = arity == 2 ? readConst(&c.program->code[c.constAt[base + 1] + 1]) : 0;
+    c.program->length = c.constAt[base];
+    c.depth = base;
+    emitConst(c, applyOp(op, a, b));
+    return;
+  }
+
+  emitByte(c, op);
+  c.depth = base;
+  pushSlot(c, -1);
+}
+
+static void parseExpr(ExprCompiler& c);
+
+static bool matchWord(ExprCompiler& c, const char* word) {
+  size_t len = strlen(word);
+  if (strncmp(c.pos, word, len) == 0 && !isalnum((unsigned char)c.pos[len])) {
+    c.pos += len;
+    return true;
+  }
+  return false;
+}
+
+static void expect(ExprCompiler& c, char ch) {
+  skipSpaces(c);
+  if (*c.pos != ch) {
+    fail(c, EXPR_ERR_SYNTAX);
+    return;
+  }
+  c.pos++;
+}
+
+static void parseNumber(ExprCompiler& c) {
+  int64_t whole = 0;
+  int64_t fraction = 0;
+  int64_t scale = 1;
+  while (isdigit((unsigned char)*c.pos)) {
+    whole = whole * 10 + (*c.pos++ - '0');
+    if (whole > 32767) {
+      fail(c, EXPR_ERR_SYNTAX);
+      return;
+    }
+  }
+  if (*c.pos == '.') {
+    c.pos++;
+    while (isdigit((unsigned char)*c.pos)) {
+      if (scale < 100000) {
+        fraction = fraction * 10 + (*c.pos - '0');
+        scale *= 10;
+      }
+      c.pos++;
+    }
+  }
+  emitConst(c, (int32_t)((whole << 16) + (fraction << 16) / scale));
+}
+
+static void parsePrimary(ExprCompiler& c) {
+  skipSpaces(c);
+  if (++c.nesting > EXPR_MAX_DEPTH) {
+    fail(c, EXPR_ERR_TOO_LONG);
+    return;
+  }
+
+  static const struct { const char* name; ExprOp op; int arity; } FUNCTIONS[] = {
+    {"sin", EXPR_SIN, 1}, {"cos", EXPR_COS, 1}, {"abs", EXPR_ABS, 1},
+    {"floor", EXPR_FLOOR, 1}, {"frac", EXPR_FRAC, 1},
+    {"min", EXPR_MIN, 2}, {"max", EXPR_MAX, 2}
+  };
+
+  if (isdigit((unsigned char)*c.pos) || *c.pos == '.') {
+    parseNumber(c);
+  }
+  else if (*c.pos == '(') {
+    c.pos++;
+    parseExpr(c);
+    expect(c, ')');
+  }
+  else if (matchWord(c, "t")) {
+    emitLoad(c, EXPR_VAR_T);
+  }
+  else if (matchWord(c, "i")) {
+    emitLoad(c, EXPR_VAR_I);
+  }
+  else if (matchWord(c, "n")) {
+    emitLoad(c, EXPR_VAR_N);
+  }
+  else if (matchWord(c, "I")) {
+    emitLoad(c, EXPR_VAR_INTENSITY);
+  }
+  else {
+    for (const auto& fn : FUNCTIONS) {
+      if (matchWord(c, fn.name)) {
+        expect(c, '(');
+        parseExpr(c);
+        if (fn.arity == 2) {
+          expect(c, ',');
+          parseExpr(c);
+        }
+        expect(c, ')');
+        emitOp(c, fn.op, fn.arity);
+        c.nesting--;
+        return;
+      }
+    }
+    fail(c, EXPR_ERR_SYNTAX);
+  }
+  c.nesting--;
+}
+
+static void parseUnary(ExprCompiler& c) {
+  skipSpaces(c);
+  if (*c.pos == '-') {
+    c.pos++;
+    parseUnary(c);
+    emitOp(c, EXPR_NEG, 1);
+  }
+  else {
+    parsePrimary(c);
+  }
+}
+
+static void parseTerm(ExprCompiler& c) {
+  parseUnary(c);
+  for (;;) {
+    skipSpaces(c);
+    char ch = *c.pos;
+    if (ch != '*' && ch != '/' && ch != '%') {
+      return;
+    }
+    c.pos++;
+    parseUnary(c);
+    emitOp(c, ch == '*' ? EXPR_MUL : ch == '/' ? EXPR_DIV : EXPR_MOD, 2);
+  }
+}
+
+static void parseExpr(ExprCompiler& c) {
+  parseTerm(c);
+  for (;;) {
+    skipSpaces(c);
+    char ch = *c.pos;
+    if (ch != '+' && ch != '-') {
+      return;
+    }
+    c.pos++;
+    parseTerm(c);
+    emitOp(c, ch == '+' ? EXPR_ADD : EXPR_SUB, 2);
+  }
+}
+
+ExprError compileExpression(const char* source, ExprProgram& program, int& errorPos) {
+  if (!sineReady) {
+    initSineTable();
+  }
+
+  ExprProgram compiled;
+  compiled.length = 0;
+  compiled.maxStack = 0;
+
+  ExprCompiler c;
+  c.source = source;
+  c.pos = source;
+  c.program = &compiled;
+  c.depth = 0;
+  c.nesting = 0;
+  c.error = strlen(source) > (size_t)EXPR_MAX_SOURCE ? EXPR_ERR_TOO_LONG : EXPR_OK;
+
+  if (c.error == EXPR_OK) {
+    parseExpr(c);
+    skipSpaces(c);
+    if (*c.pos != '\0') {
+      fail(c, EXPR_ERR_SYNTAX);
+    }
+    emitByte(c, EXPR_END);
+  }
+
+  errorPos = c.pos - source;
+  if (c.error == EXPR_OK) {
+    program = compiled;
+  }
+  return c.error;
+}
+
+// ==================== INTERPRETER ====================
+// Folding uses the same arithmetic as the interpreter
+static int32_t applyOp(ExprOp op, int32_t a, int32_t b) {
+  switch (op) {
+    case EXPR_ADD:   return q16Add(a, b);
+    case EXPR_SUB:   return q16Sub(a, b);
+    case EXPR_MUL:   return q16Mul(a, b);
+    case EXPR_DIV:   return q16Div(a, b);
+    case EXPR_MOD:   return q16Mod(a, b);
+    case EXPR_NEG:   return q16Neg(a);
+    case EXPR_SIN:   return q16Sin(a);
+    case EXPR_COS:   return q16Sin(q16Add(a, Q16_HALF_PI));
+    case EXPR_ABS:   return q16Abs(a);
+    case EXPR_FLOOR: return a & ~(Q16_ONE - 1);
+    case EXPR_FRAC:  return a & (Q16_ONE - 1);
+    case EXPR_MIN:   return a < b ? a : b;
+    case EXPR_MAX:   return a > b ? a : b;
+    default:         return 0;
+  }
+}
+
+int32_t evaluateExpression(const ExprProgram& program, const ExprInputs& inputs, int32_t index) {
+  int32_t stack[EXPR_MAX_STACK];
+  int32_t* top = stack - 1;
+  const uint8_t* pc = program.code;
+
+  for (;;) {
+    switch (*pc++) {
+      case EXPR_END:   return top >= stack ? *top : 0;
+      case EXPR_CONST: *++top = readConst(pc); pc += 4; break;
+      case EXPR_VAR_T: *++top = inputs.t; break;
+      case EXPR_VAR_I: *++top = index; break;
+      case EXPR_VAR_N: *++top = inputs.n; break;
+      case EXPR_VAR_INTENSITY: *++top = inputs.intensity; break;
+      case EXPR_ADD:   top--; top[0] = q16Add(top[0], top[1]); break;
+      case EXPR_SUB:   top--; top[0] = q16Sub(top[0], top[1]); break;
+      case EXPR_MUL:   top--; top[0] = q16Mul(top[0], top[1]); break;
+      case EXPR_DIV:   top--; top[0] = q16Div(top[0], top[1]); break;
+      case EXPR_MOD:   top--; top[0] = q16Mod(top[0], top[1]); break;
+      case EXPR_MIN:   top--; top[0] = top[0] < top[1] ? top[0] : top[1]; break;
+      case EXPR_MAX:   top--; top[0] = top[0] > top[1] ? top[0] : top[1]; break;
+      case EXPR_NEG:   *top = q16Neg(*top); break;
+      case EXPR_SIN:   *top = q16Sin(*top); break;
+      case EXPR_COS:   *top = q16Sin(q16Add(*top, Q16_HALF_PI)); break;
+      case EXPR_ABS:   *top = q16Abs(*top); break;
+      case EXPR_FLOOR: *top &= ~(Q16_ONE - 1); break;
+      case EXPR_FRAC:  *top &= Q16_ONE - 1; break;
+      default:         return 0;
+    }
+  }
+}
+
+void renderExpression(const ExprProgram& program, const ExprInputs& inputs, MotorFrame& frame) {
+  Motors::forEach([&](int i) {
+    int32_t value = evaluateExpression(program, inputs, i << 16) >> 16;
+    frame.values[i] = value < 0 ? 0 : (value > 255 ? 255 : value);
+  });
+}
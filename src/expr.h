@@ -0,0 +1,89 @@
+/*
+ * Smart Sheet - Pattern expressions
+ * PATTERN:<expr> compiles a small arithmetic expression once into
+ * fixed-point (Q16.16) RPN bytecode, which a tight stack interpreter then
+ * evaluates per motor per tick.
+ *
+ * Variables (case-sensitive):
+ *   t  time since the pattern started, in seconds; restarts from 0 every
+ *      EXPR_T_PERIOD_S so it never overflows Q16.16 on long sessions
+ *   i  motor index, 0..n-1
+ *   n  number of motors
+ *   I  layer intensity, 0-255
+ * Operators: + - * / % and unary minus, with parentheses
+ * Functions: sin cos abs floor frac min(a,b) max(a,b)
+ *
+ * The result is clamped to 0-255, e.g. "(sin(t*2 + i*0.8)+1)/2*I".
+ *
+ * The compiler tracks stack depth, so programs that could exceed the
+ * stack or instruction limits are rejected up front and the interpreter
+ * needs no bounds checks. Constant subexpressions are folded.
+ */
+
+#ifndef SMARTSHEET_EXPR_H
+#define SMARTSHEET_EXPR_H
+
+#include <Arduino.h>
+#include "frame.h"
+
+// ==================== EXPRESSION LIMITS ====================
+const int EXPR_MAX_SOURCE = 128;
+const int EXPR_MAX_CODE = 96;              // Bytes of bytecode
+const int EXPR_MAX_STACK = 8;
+const int EXPR_MAX_DEPTH = 16;             // Parser nesting
+const int EXPR_TICK_MS = 10;
+const uint32_t EXPR_T_PERIOD_S = 3600;     // Leaves headroom for t * 8
+
+enum ExprOp {
+  EXPR_END,
+  EXPR_CONST,                              // Followed by a 4-byte Q16.16 value
+  EXPR_VAR_T,
+  EXPR_VAR_I,
+  EXPR_VAR_N,
+  EXPR_VAR_INTENSITY,
+  EXPR_ADD,
+  EXPR_SUB,
+  EXPR_MUL,
+  EXPR_DIV,
+  EXPR_MOD,
+  EXPR_NEG,
+  EXPR_SIN,
+  EXPR_COS,
+  EXPR_ABS,
+  EXPR_FLOOR,
+  EXPR_FRAC,
+  EXPR_MIN,
+  EXPR_MAX
+};
+
+enum ExprError {
+  EXPR_OK,
+  EXPR_ERR_SYNTAX,
+  EXPR_ERR_TOO_LONG,
+  EXPR_ERR_STACK
+};
+
+struct ExprProgram {
+  uint8_t code[EXPR_MAX_CODE];
+  uint8_t length;
+  uint8_t maxStack;
+};
+
+// Per-tick inputs shared by every motor, in Q16.16
+struct ExprInputs {
+  int32_t t;
+  int32_t n;
+  int32_t intensity;
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+ExprError compileExpression(const char* source, ExprProgram& program, int& errorPos);
+int32_t evaluateExpression(const ExprProgram& program, const ExprInputs& inputs, int32_t index);
+void renderExpression(const ExprProgram& program, const ExprInputs& inputs, MotorFrame& frame);
+
+// Active PATTERN: program, shared by every layer in MODE_EXPR; t counts
+// from expressionStartTime
+extern ExprProgram activeExpression;
+extern unsigned long expressionStartTime;
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * Smart Sheet - Motor frame
+ * One intensity or duty per motor, padded to whole 32-bit words so frame
+ * operations can work four motors at a time (see swar.h). Padding lanes
+ * are always zero.
+ */
+
+#ifndef SMARTSHEET_FRAME_H
+#define SMARTSHEET_FRAME_H
+
+#include <stdint.h>
+#include "config.h"
+
+const int FRAME_WORDS = (NUM_MOTORS + 3) / 4;
+
+struct MotorFrame {
+  union {
+    uint8_t values[FRAME_WORDS * 4];
+    uint32_t words[FRAME_WORDS];
+  };
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Smart Sheet - Compressed frame streams
+ * Incremental LZSS decoder with delta reconstruction
+ */
+
+#include "frame_codec.h"
+
+// The window head is a uint8_t and wraps on its own
+static_assert(LZ_WINDOW_SIZE == 256, "Window indexing assumes a 256-byte window");
+
+// ==================== BIT READER ====================
+static inline void refill(FrameDecoder& d) {
+  while (d.bitCount <= 24 && d.inputPos < d.inputLength) {
+    d.bits |= (uint32_t)d.input[d.inputPos++] << (24 - d.bitCount);
+    d.bitCount += 8;
+  }
+}
+
+// Returns -1 once the stream is exhausted
+static inline int readBits(FrameDecoder& d, int count) {
+  if (d.bitCount < count) {
+    refill(d);
+    if (d.bitCount < count) {
+      return -1;
+    }
+  }
+  int value = d.bits >> (32 - count);
+  d.bits <<= count;
+  d.bitCount -= count;
+  return value;
+}
+
+// ==================== DECODER ====================
+void beginFrameDecode(FrameDecoder& decoder, const uint8_t* input, uint32_t length) {
+  decoder.input = input;
+  decoder.inputLength = length;
+  decoder.inputPos = 0;
+  decoder.bits = 0;
+  decoder.bitCount = 0;
+  memset(decoder.window, 0, sizeof(decoder.window));
+  decoder.head = 0;
+  decoder.copyDistance = 0;
+  decoder.copyRemaining = 0;
+}
+
+// Produces one decoded byte, or -1 at the end of the stream
+static inline int nextByte(FrameDecoder& d) {
+  if (d.copyRemaining == 0) {
+    int tag = readBits(d, 1);
+    if (tag < 0) {
+      return -1;
+    }
+    if (tag) {
+      int literal = readBits(d, 8);
+      if (literal < 0) {
+        return -1;
+      }
+      d.window[d.head++] = literal;
+      return literal;
+    }
+    int distance = readBits(d, LZ_WINDOW_BITS);
+    int length = distance < 0 ? -1 : readBits(d, LZ_LENGTH_BITS);
+    if (length < 0) {
+      return -1;
+    }
+    d.copyDistance = distance + 1;
+    d.copyRemaining = length + LZ_MIN_MATCH;
+  }
+
+  d.copyRemaining--;
+  uint8_t value = d.window[(uint8_t)(d.head - d.copyDistance)];
+  d.window[d.head++] = value;
+  return value;
+}
+
+bool decodeFrameRow(FrameDecoder& decoder, uint8_t* row, int motors) {
+  for (int i = 0; i < motors; i++) {
+    int delta = nextByte(decoder);
+    if (delta < 0) {
+      return false;
+    }
+    row[i] += delta;
+  }
+  return true;
+}
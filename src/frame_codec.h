@@ -0,0 +1,50 @@
+/*
+ * Smart Sheet - Compressed frame streams
+ * Recorded frame sequences are stored as per-motor deltas against the
+ * previous frame (the first against all zeros), then packed with a
+ * small-window LZSS coder in the style of heatshrink. Steady or slowly
+ * ramping channels become long runs of small deltas, which the LZ stage
+ * collapses into back-references.
+ *
+ * Bit stream, MSB first:
+ *   1 <8 bits>                               literal byte
+ *   0 <LZ_WINDOW_BITS> <LZ_LENGTH_BITS>      copy (distance - 1), (length - LZ_MIN_MATCH)
+ * Copies may overlap their own output (distance < length) for runs.
+ *
+ * The decoder is incremental: each call produces one frame, using the
+ * 256-byte history window as its only buffer, so RAM use is fixed and
+ * per-frame work is proportional to the motor count. Encoding happens on
+ * the host, see tools/pack_library.py.
+ */
+
+#ifndef SMARTSHEET_FRAME_CODEC_H
+#define SMARTSHEET_FRAME_CODEC_H
+
+#include <Arduino.h>
+
+// ==================== CODEC PARAMETERS ====================
+const int LZ_WINDOW_BITS = 8;
+const int LZ_WINDOW_SIZE = 1 << LZ_WINDOW_BITS;
+const int LZ_LENGTH_BITS = 4;
+const int LZ_MIN_MATCH = 2;
+
+struct FrameDecoder {
+  const uint8_t* input;
+  uint32_t inputLength;
+  uint32_t inputPos;                         // Next byte to load into bits
+  uint32_t bits;                             // Left-aligned bit buffer
+  int bitCount;
+  uint8_t window[LZ_WINDOW_SIZE];            // Decoded history, ring indexed by head
+  uint8_t head;
+  uint16_t copyDistance;
+  uint8_t copyRemaining;
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+void beginFrameDecode(FrameDecoder& decoder, const uint8_t* input, uint32_t length);
+
+// Decodes the next frame's deltas and applies them to row, which holds the
+// previous frame. Returns false if the stream ends early.
+bool decodeFrameRow(FrameDecoder& decoder, uint8_t* row, int motors);
+
+#endif
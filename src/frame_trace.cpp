@@ -0,0 +1,125 @@
+/*
+ * Smart Sheet - Frame trace recorder
+ */
+
+#include "frame_trace.h"
+#include "hal/clock.h"
+#include "rom/crc.h"
+
+// ==================== GLOBAL VARIABLES ====================
+static uint8_t blocks[TRACE_BLOCKS][TRACE_BLOCK_SIZE];
+static int head = 0;                 // Block being filled
+static int blocksUsed = 0;
+static uint16_t used = 0;            // Bytes used in the head block
+static unsigned long lastFrameUs = 0;
+static uint32_t frames = 0;
+
+static inline void writeUsed() {
+  blocks[head][0] = used & 0xFF;
+  blocks[head][1] = used >> 8;
+}
+
+// ==================== RECORDING ====================
+void clearFrameTrace() {
+  head = 0;
+  blocksUsed = 0;
+  used = 0;
+  frames = 0;
+}
+
+// The keyframe carries the whole frame, so the frame that opens a block
+// needs no record of its own
+static void startBlock(unsigned long now, const uint8_t* duties) {
+  if (blocksUsed > 0) {
+    head = (head + 1) % TRACE_BLOCKS;
+  }
+  if (blocksUsed < TRACE_BLOCKS) {
+    blocksUsed++;
+  }
+
+  uint8_t* block = blocks[head];
+  block[2] = now & 0xFF;
+  block[3] = (now >> 8) & 0xFF;
+  block[4] = (now >> 16) & 0xFF;
+  block[5] = (now >> 24) & 0xFF;
+  memcpy(block + 6, duties, NUM_MOTORS);
+  used = TRACE_HEADER_SIZE;
+  writeUsed();
+}
+
+void traceFrame(uint64_t changed, const uint8_t* duties) {
+  unsigned long now = Clock::micros();
+  frames++;
+  if (blocksUsed == 0 || used + TRACE_MAX_RECORD > TRACE_BLOCK_SIZE) {
+    startBlock(now, duties);
+    lastFrameUs = now;
+    return;
+  }
+
+  uint8_t* out = blocks[head] + used;
+  for (int b = 0; b < TRACE_MASK_BYTES; b++) {
+    *out++ = changed >> (8 * b);
+  }
+
+  uint32_t delta = now - lastFrameUs;
+  while (delta >= 0x80) {
+    *out++ = (delta & 0x7F) | 0x80;
+    delta >>= 7;
+  }
+  *out++ = delta;
+
+  while (changed) {
+    *out++ = duties[__builtin_ctzll(changed)];
+    changed &= changed - 1;
+  }
+
+  used = out - blocks[head];
+  writeUsed();
+  lastFrameUs = now;
+}
+
+// ==================== STATUS ====================
+static inline int oldestBlock() {
+  return (head + TRACE_BLOCKS - blocksUsed + 1) % TRACE_BLOCKS;
+}
+
+static inline uint16_t blockUsed(int block) {
+  return blocks[block][0] | (blocks[block][1] << 8);
+}
+
+FrameTraceStatus getFrameTraceStatus() {
+  FrameTraceStatus status;
+  status.frames = frames;
+  status.blocks = blocksUsed;
+  status.bytes = 0;
+  status.spanUs = 0;
+  for (int k = 0; k < blocksUsed; k++) {
+    status.bytes += blockUsed((oldestBlock() + k) % TRACE_BLOCKS);
+  }
+  if (blocksUsed > 0) {
+    const uint8_t* oldest = blocks[oldestBlock()];
+    unsigned long start = oldest[2] | (oldest[3] << 8) | (oldest[4] << 16) | 
+                          ((unsigned long)oldest[5] << 24);
+    status.spanUs = lastFrameUs - start;
+  }
+  return status;
+}
+
+// ==================== DUMP ====================
+uint32_t frameTraceCrc() {
+  uint32_t crc = 0;
+  for (int k = 0; k < blocksUsed; k++) {
+    int block = (oldestBlock() + k) % TRACE_BLOCKS;
+    crc = crc32_le(crc, blocks[block], blockUsed(block));
+  }
+  return crc;
+}
+
+// Oldest block first; loop() is blocked meanwhile, so nothing is recorded
+// into the ring while it is being sent
+void dumpFrameTrace(Stream& out) {
+  for (int k = 0; k < blocksUsed; k++) {
+    int block = (oldestBlock() + k) % TRACE_BLOCKS;
+    out.write(blocks[block], blockUsed(block));
+  }
+}
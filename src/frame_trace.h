@@ -0,0 +1,53 @@
+/*
+ * Smart Sheet - Frame trace recorder
+ * Keeps the most recent committed frames (post calibration and limit,
+ * as handed to the shaper and driver) in a fixed RAM ring for field
+ * diagnosis, and streams it out in binary with TRACE:DUMP.
+ *
+ * The ring is TRACE_BLOCKS blocks of TRACE_BLOCK_SIZE bytes. Each block
+ * decodes on its own, so the oldest one is simply overwritten:
+ *
+ *   u16 used bytes (including this header)
+ *   u32 start time, Clock::micros()
+ *   u8  duty[NUM_MOTORS]                     keyframe, state at start
+ *   records until used:
+ *     u8  changed[TRACE_MASK_BYTES]          bit m = motor m, LSB first
+ *     varint time since the previous frame   LEB128, microseconds
+ *     u8  duty for each changed motor, ascending
+ *
+ * Multi-byte fields are little-endian. Recording appends a handful of
+ * bytes per frame and never allocates; see tools/trace_dump.py for the
+ * host side.
+ */
+
+#ifndef SMARTSHEET_FRAME_TRACE_H
+#define SMARTSHEET_FRAME_TRACE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ==================== TRACE CONFIGURATION ====================
+const int TRACE_BLOCKS = 16;
+const int TRACE_BLOCK_SIZE = 512;
+const int TRACE_MASK_BYTES = (NUM_MOTORS + 7) / 8;
+const int TRACE_HEADER_SIZE = 6 + NUM_MOTORS;
+const int TRACE_MAX_RECORD = TRACE_MASK_BYTES + 5 + NUM_MOTORS;
+
+static_assert(TRACE_HEADER_SIZE + TRACE_MAX_RECORD <= TRACE_BLOCK_SIZE,
+              "Trace block too small for one record");
+
+struct FrameTraceStatus {
+  uint32_t frames;                   // Recorded since the last clear
+  int blocks;                        // Blocks holding data
+  uint32_t bytes;                    // Bytes a dump would send
+  unsigned long spanUs;              // Oldest block start to newest frame
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+void clearFrameTrace();
+void traceFrame(uint64_t changed, const uint8_t* duties);
+FrameTraceStatus getFrameTraceStatus();
+uint32_t frameTraceCrc();
+void dumpFrameTrace(Stream& out);
+
+#endif
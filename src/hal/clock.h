@@ -0,0 +1,60 @@
+/*
+ * Smart Sheet - Clock
+ * Time sources for the firmware logic, selected at compile time like the
+ * motor driver so the ESP32 build calls the Arduino core directly:
+ *
+ *   static unsigned long millis();
+ *   static unsigned long micros();
+ *   static uint32_t cycles();             - free-running cycle counter
+ *   static uint32_t cyclesPerMicro();     - counter rate
+ *
+ * Native builds (-D NATIVE_BUILD) count host time in nanoseconds, so cycle
+ * figures from host benchmarks read as ns. The simulator (-D SIMULATOR)
+ * keeps host cycles but runs millis()/micros() on simulated time that
+ * only moves when the simulator advances it.
+ */
+
+#ifndef SMARTSHEET_CLOCK_H
+#define SMARTSHEET_CLOCK_H
+
+#include <Arduino.h>
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+
+struct SimClock {
+  static unsigned long millis();
+  static unsigned long micros();
+  static uint32_t cycles();
+  static uint32_t cyclesPerMicro() { return 1000; }
+
+  static uint64_t nowMicros();
+  static void advance(uint32_t us);
+};
+
+typedef SimClock Clock;
+
+#elif defined(NATIVE_BUILD)
+
+struct HostClock {
+  static unsigned long millis();
+  static unsigned long micros();
+  static uint32_t cycles();
+  static uint32_t cyclesPerMicro() { return 1000; }
+};
+
+typedef HostClock Clock;
+
+#else
+
+struct ArduinoClock {
+  static inline unsigned long millis() { return ::millis(); }
+  static inline unsigned long micros() { return ::micros(); }
+  static inline uint32_t cycles() { return ESP.getCycleCount(); }
+  static inline uint32_t cyclesPerMicro() { return ESP.getCpuFreqMHz(); }
+};
+
+typedef ArduinoClock Clock;
+
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Smart Sheet - ESP32 task introspection
+ * Uses uxTaskGetSystemState() where the FreeRTOS trace facility is built
+ * in, otherwise reports only the calling (loop) task.
+ */
+
+#include "system.h"
+
+#if !defined(NATIVE_BUILD)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if configUSE_TRACE_FACILITY
+const int SYSTEM_MAX_TASKS = 24;
+static TaskStatus_t taskStatus[SYSTEM_MAX_TASKS];   // Off the loop task stack
+#endif
+
+int EspSystem::taskStats(TaskStat* stats, int max, uint32_t& runTimeTotal) {
+  runTimeTotal = 0;
+#if configUSE_TRACE_FACILITY
+  // Returns 0 if there are more tasks than entries
+  int count = uxTaskGetSystemState(taskStatus, SYSTEM_MAX_TASKS, &runTimeTotal);
+  int filled = 0;
+  for (int k = 0; k < count && filled < max; k++) {
+    stats[filled].id = taskStatus[k].xHandle;
+    stats[filled].name = taskStatus[k].pcTaskName;
+    stats[filled].stackFree = taskStatus[k].usStackHighWaterMark;
+#if configGENERATE_RUN_TIME_STATS
+    stats[filled].runTime = taskStatus[k].ulRunTimeCounter;
+#else
+    stats[filled].runTime = 0;
+#endif
+    filled++;
+  }
+  return filled;
+#else
+  if (max < 1) {
+    return 0;
+  }
+  stats[0].id = xTaskGetCurrentTaskHandle();
+  stats[0].name = pcTaskGetName(NULL);
+  stats[0].stackFree = uxTaskGetStackHighWaterMark(NULL);
+  stats[0].runTime = 0;
+  return 1;
+#endif
+}
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Smart Sheet - Host clock
+ * Monotonic host time, counted from process start
+ */
+
+#include "clock.h"
+
+#if defined(NATIVE_BUILD) && !defined(SIMULATOR)
+#include <chrono>
+
+static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+static uint64_t elapsedNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - origin).count();
+}
+
+unsigned long HostClock::millis() {
+  return elapsedNanos() / 1000000;
+}
+
+unsigned long HostClock::micros() {
+  return elapsedNanos() / 1000;
+}
+
+uint32_t HostClock::cycles() {
+  return (uint32_t)elapsedNanos();
+}
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Smart Sheet - Native Arduino subset
+ * Just enough of the Arduino core (String, Print/Stream, Serial and the
+ * math helpers) for the firmware logic to build on a host. Only on the
+ * include path of [env:native]. Time and I/O deliberately go through the
+ * HAL (hal/clock.h, hal/transport.h) instead of millis() and SerialBT.
+ */
+
+#ifndef SMARTSHEET_NATIVE_ARDUINO_H
+#define SMARTSHEET_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+using std::min;
+using std::max;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+// Hardware settle waits (oscillator start-up and the like) have nothing
+// to wait for on a host
+inline void delayMicroseconds(unsigned int us) { (void)us; }
+
+template <class T, class L, class H>
+inline T constrain(T x, L low, H high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+// ==================== STRING ====================
+#define DEC 10
+#define HEX 16
+
+class String {
+public:
+  String() {}
+  String(const char* text) : value(text ? text : "") {}
+  String(const std::string& text) : value(text) {}
+  explicit String(char c) : value(1, c) {}
+  String(int v, unsigned char base = DEC) : value(format(v, base)) {}
+  String(unsigned int v, unsigned char base = DEC) : value(format(v, base)) {}
+  String(long v, unsigned char base = DEC) : value(format(v, base)) {}
+  String(unsigned long v, unsigned char base = DEC) : value(format(v, base)) {}
+  String(long long v) : value(std::to_string(v)) {}
+  String(unsigned long long v) : value(std::to_string(v)) {}
+  String(double v, unsigned char decimals = 2) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, v);
+    value = text;
+  }
+
+  unsigned int length() const { return value.size(); }
+  const char* c_str() const { return value.c_str(); }
+  char charAt(unsigned int index) const { return index < value.size() ? value[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  bool startsWith(const String& prefix) const {
+    return value.compare(0, prefix.value.size(), prefix.value) == 0;
+  }
+  bool endsWith(const String& suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t at = value.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  int indexOf(const String& text, unsigned int from = 0) const {
+    size_t at = value.find(text.value, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  String substring(unsigned int from) const {
+    return from < value.size() ? String(value.substr(from)) : String();
+  }
+  String substring(unsigned int from, unsigned int to) const {
+    if (to > value.size()) {
+      to = value.size();
+    }
+    return from < to ? String(value.substr(from, to - from)) : String();
+  }
+
+  long toInt() const { return atol(value.c_str()); }
+  float toFloat() const { return atof(value.c_str()); }
+
+  void toUpperCase() {
+    for (char& c : value) {
+      c = toupper((unsigned char)c);
+    }
+  }
+  void toLowerCase() {
+    for (char& c : value) {
+      c = tolower((unsigned char)c);
+    }
+  }
+  void trim() {
+    size_t start = value.find_first_not_of(" \t\r\n");
+    size_t end = value.find_last_not_of(" \t\r\n");
+    value = start == std::string::npos ? std::string() : value.substr(start, end - start + 1);
+  }
+
+  bool concat(const String& text) { value += text.value; return true; }
+  bool concat(char c) { value += c; return true; }
+  String& operator+=(const String& text) { value += text.value; return *this; }
+  String& operator+=(const char* text) { value += text; return *this; }
+  String& operator+=(char c) { value += c; return *this; }
+
+  bool equals(const String& other) const { return value == other.value; }
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* other) const { return value == other; }
+  bool operator!=(const String& other) const { return value != other.value; }
+  bool operator!=(const char* other) const { return value != other; }
+
+  friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+  friend String operator+(const String& a, const char* b) { return String(a.value + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.value); }
+  friend String operator+(const String& a, char b) { return String(a.value + b); }
+
+private:
+  // Negative values print in two's complement outside base 10, as on Arduino
+  template <class T>
+  static std::string format(T v, unsigned char base) {
+    if (base == DEC) {
+      return std::to_string(v);
+    }
+    char text[24];
+    snprintf(text, sizeof(text), "%llx", (unsigned long long)(typename std::make_unsigned<T>::type)v);
+    return text;
+  }
+
+  std::string value;
+};
+
+// ==================== PRINT / STREAM ====================
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+
+  size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned int v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+
+  size_t println() { return print("\r\n"); }
+  template <class T>
+  size_t println(const T& v) { return print(v) + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  virtual void flush() {}
+
+  void setTimeout(unsigned long ms) { (void)ms; }
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = read();
+      if (c < 0) {
+        break;
+      }
+      buffer[count++] = c;
+    }
+    return count;
+  }
+  size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+  String readStringUntil(char terminator) {
+    std::string text;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+      text += (char)c;
+    }
+    return String(text);
+  }
+};
+
+// Console log: writes to stderr so stdout stays the command transport
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Smart Sheet - Native Preferences
+ * In-memory stand-in for the NVS-backed Arduino Preferences; settings
+ * last for the life of the process.
+ */
+
+#ifndef SMARTSHEET_NATIVE_PREFERENCES_H
+#define SMARTSHEET_NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end() {}
+  size_t putBytes(const char* key, const void* value, size_t length);
+  size_t getBytes(const char* key, void* buffer, size_t length);
+  size_t getBytesLength(const char* key);
+
+private:
+  std::string space;
+  bool readOnly = false;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Smart Sheet - Native flash partitions
+ * The "patterns" library partition, backed by a file named by the
+ * SMARTSHEET_LIBRARY environment variable (created erased if missing).
+ * Writes follow NOR rules: programming only clears bits.
+ */
+
+#ifndef SMARTSHEET_NATIVE_ESP_PARTITION_H
+#define SMARTSHEET_NATIVE_ESP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef int spi_flash_mmap_handle_t;
+
+typedef enum {
+  SPI_FLASH_MMAP_DATA,
+  SPI_FLASH_MMAP_INST
+} spi_flash_mmap_memory_t;
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  esp_partition_subtype_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void** out,
+                             spi_flash_mmap_handle_t* handle);
+void spi_flash_munmap(spi_flash_mmap_handle_t handle);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset,
+                              const void* data, size_t size);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset,
+                             void* data, size_t size);
+
+#endif
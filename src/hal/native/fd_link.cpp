@@ -0,0 +1,103 @@
+/*
+ * Smart Sheet - File descriptor link
+ */
+
+#if defined(NATIVE_BUILD)
+
+#include "fd_link.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+void FdLink::attach(int inputFd, int outputFd) {
+  input = inputFd;
+  output = outputFd;
+  inputClosed = false;
+  pending.clear();
+}
+
+void FdLink::fill() {
+  struct pollfd request = {input, POLLIN, 0};
+  while (!inputClosed && input >= 0 && poll(&request, 1, 0) > 0) {
+    char buffer[512];
+    ssize_t count = ::read(input, buffer, sizeof(buffer));
+    if (count < 0 && (errno == EAGAIN || errno == EINTR)) {
+      break;
+    }
+    if (count <= 0) {
+      inputClosed = true;
+      break;
+    }
+    pending.append(buffer, count);
+  }
+}
+
+bool FdLink::pollLine(String& line) {
+  fill();
+  for (;;) {
+    size_t end = pending.find('\n');
+    if (end == std::string::npos) {
+      if (!inputClosed || pending.empty()) {
+        return false;
+      }
+      end = pending.size();
+    }
+
+    line = String(pending.substr(0, end));
+    pending.erase(0, end < pending.size() ? end + 1 : end);
+    line.trim();
+    if (line.length() > 0) {
+      return true;
+    }
+  }
+}
+
+bool FdLink::isOpen() {
+  fill();
+  return !inputClosed || !pending.empty();
+}
+
+// Only terminals (including PTYs) can report this; pipes and files read 0
+int FdLink::queued() {
+  int count = 0;
+  if (ioctl(output, TIOCOUTQ, &count) != 0) {
+    return 0;
+  }
+  return count;
+}
+
+int FdLink::available() {
+  fill();
+  return pending.size();
+}
+
+int FdLink::read() {
+  if (available() == 0) {
+    return -1;
+  }
+  uint8_t c = pending[0];
+  pending.erase(0, 1);
+  return c;
+}
+
+size_t FdLink::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t FdLink::write(const uint8_t* buffer, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t count = ::write(output, buffer + done, size - done);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      break;
+    }
+    done += count;
+  }
+  return done;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Smart Sheet - File descriptor link
+ * A Stream over a pair of host file descriptors, read without blocking.
+ * Host transports use it both for command lines and as the raw byte link
+ * for bulk uploads.
+ */
+
+#ifndef SMARTSHEET_NATIVE_FD_LINK_H
+#define SMARTSHEET_NATIVE_FD_LINK_H
+
+#include <Arduino.h>
+
+class FdLink : public Stream {
+public:
+  void attach(int inputFd, int outputFd);
+
+  // Next complete, trimmed, non-empty line; a final unterminated line
+  // counts once input has closed
+  bool pollLine(String& line);
+  bool isOpen();
+  int queued();                      // Output bytes the reader has not taken
+
+  int available() override;
+  int read() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+private:
+  void fill();
+
+  int input = -1;
+  int output = -1;
+  bool inputClosed = false;
+  std::string pending;
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Smart Sheet - Native FreeRTOS subset
+ * Tasks run as host threads; critical sections are one global mutex.
+ */
+
+#ifndef SMARTSHEET_NATIVE_FREERTOS_H
+#define SMARTSHEET_NATIVE_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+
+typedef struct {
+  int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void nativeEnterCritical(portMUX_TYPE* mux);
+void nativeExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) nativeEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) nativeExitCritical(mux)
+
+#endif
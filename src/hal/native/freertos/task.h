@@ -0,0 +1,17 @@
+/*
+ * Smart Sheet - Native FreeRTOS tasks
+ */
+
+#ifndef SMARTSHEET_NATIVE_FREERTOS_TASK_H
+#define SMARTSHEET_NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+void xTaskNotifyGive(TaskHandle_t task);
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ * Smart Sheet - Native platform
+ * Host implementations behind the native Arduino subset, plus the
+ * setup()/loop() entry point
+ */
+
+#if defined(NATIVE_BUILD)
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stdarg.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "esp_partition.h"
+#include "rom/crc.h"
+#include "freertos/task.h"
+#include "../transport.h"
+
+// ==================== SERIAL ====================
+HardwareSerial Serial;
+
+size_t Print::printf(const char* format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  return write((const uint8_t*)text, min((size_t)length, sizeof(text) - 1));
+}
+
+// ==================== PREFERENCES ====================
+static std::map<std::string, std::vector<uint8_t>> preferenceStore;
+
+bool Preferences::begin(const char* name, bool readOnlyMode) {
+  space = name;
+  readOnly = readOnlyMode;
+  return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  if (readOnly) {
+    return 0;
+  }
+  const uint8_t* bytes = (const uint8_t*)value;
+  preferenceStore[space + "/" + key].assign(bytes, bytes + length);
+  return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+  auto found = preferenceStore.find(space + "/" + key);
+  if (found == preferenceStore.end() || found->second.size() > length) {
+    return 0;
+  }
+  memcpy(buffer, found->second.data(), found->second.size());
+  return found->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  auto found = preferenceStore.find(space + "/" + key);
+  return found == preferenceStore.end() ? 0 : found->second.size();
+}
+
+// ==================== FLASH PARTITION ====================
+// Mirrors the "patterns" entry in partitions.csv
+static const esp_partition_t libraryPartition = {
+  ESP_PARTITION_TYPE_DATA, 0x40, 0x3D0000, 0x30000, "patterns"
+};
+static std::vector<uint8_t> flash;
+
+static void loadFlash() {
+  if (!flash.empty()) {
+    return;
+  }
+  flash.assign(libraryPartition.size, 0xFF);
+  const char* path = getenv("SMARTSHEET_LIBRARY");
+  FILE* file = path ? fopen(path, "rb") : NULL;
+  if (file) {
+    size_t loaded = fread(flash.data(), 1, flash.size(), file);
+    (void)loaded;
+    fclose(file);
+  }
+}
+
+static void saveFlash() {
+  const char* path = getenv("SMARTSHEET_LIBRARY");
+  FILE* file = path ? fopen(path, "wb") : NULL;
+  if (file) {
+    fwrite(flash.data(), 1, flash.size(), file);
+    fclose(file);
+  }
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+  if (type != libraryPartition.type || subtype != libraryPartition.subtype ||
+      (label && strcmp(label, libraryPartition.label) != 0)) {
+    return NULL;
+  }
+  loadFlash();
+  return &libraryPartition;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void** out,
+                             spi_flash_mmap_handle_t* handle) {
+  (void)memory;
+  if (offset + size > partition->size) {
+    return ESP_FAIL;
+  }
+  *out = flash.data() + offset;
+  *handle = 1;
+  return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {
+  (void)handle;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  if (offset % 4096 != 0 || size % 4096 != 0 || offset + size > partition->size) {
+    return ESP_FAIL;
+  }
+  memset(flash.data() + offset, 0xFF, size);
+  saveFlash();
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset,
+                              const void* data, size_t size) {
+  if (offset + size > partition->size) {
+    return ESP_FAIL;
+  }
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t k = 0; k < size; k++) {
+    flash[offset + k] &= bytes[k];
+  }
+  saveFlash();
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset,
+                             void* data, size_t size) {
+  if (offset + size > partition->size) {
+    return ESP_FAIL;
+  }
+  memcpy(data, flash.data() + offset, size);
+  return ESP_OK;
+}
+
+// ==================== ROM CRC ====================
+uint32_t crc32_le(uint32_t crc, const uint8_t* buffer, uint32_t length) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) {
+        c = (c >> 1) ^ (0xEDB88320 & (0 - (c & 1)));
+      }
+      table[n] = c;
+    }
+  }
+  crc = ~crc;
+  while (length--) {
+    crc = table[(crc ^ *buffer++) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// ==================== FREERTOS ====================
+struct NativeTask {
+  std::mutex lock;
+  std::condition_variable wake;
+  uint32_t notifications = 0;
+};
+
+static std::recursive_mutex criticalLock;
+static thread_local NativeTask* currentTask = NULL;
+
+void nativeEnterCritical(portMUX_TYPE* mux) {
+  (void)mux;
+  criticalLock.lock();
+}
+
+void nativeExitCritical(portMUX_TYPE* mux) {
+  (void)mux;
+  criticalLock.unlock();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  // Host threads take no stack size, priority or core
+  (void)name;
+  (void)stack;
+  (void)priority;
+  (void)core;
+  NativeTask* native = new NativeTask();
+  if (handle) {
+    *handle = native;
+  }
+  std::thread([task, param, native]() {
+    currentTask = native;
+    task(param);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+// Always waits for a notification; every caller uses portMAX_DELAY
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  (void)wait;
+  NativeTask* task = currentTask;
+  std::unique_lock<std::mutex> guard(task->lock);
+  task->wake.wait(guard, [task]() { return task->notifications > 0; });
+  uint32_t count = task->notifications;
+  task->notifications = clear ? 0 : count - 1;
+  return count;
+}
+
+void xTaskNotifyGive(TaskHandle_t handle) {
+  NativeTask* task = (NativeTask*)handle;
+  if (task == NULL) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(task->lock);
+  task->notifications++;
+  task->wake.notify_one();
+}
+
+// ==================== ENTRY POINT ====================
+// The simulator has its own, see hal/sim/sim_main.cpp; unit tests bring
+// their own as well
+#if !defined(SIMULATOR) && !defined(PIO_UNIT_TESTING)
+void setup();
+void loop();
+
+// Runs until stdin closes and every queued command has been handled
+int main() {
+  setup();
+  while (Transport::connected()) {
+    loop();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  return 0;
+}
+#endif
+
+#endif
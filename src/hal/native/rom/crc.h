@@ -0,0 +1,13 @@
+/*
+ * Smart Sheet - Native ROM CRC
+ * Same CRC-32 (zlib polynomial) as the ESP32 ROM's crc32_le.
+ */
+
+#ifndef SMARTSHEET_NATIVE_ROM_CRC_H
+#define SMARTSHEET_NATIVE_ROM_CRC_H
+
+#include <stdint.h>
+
+uint32_t crc32_le(uint32_t crc, const uint8_t* buffer, uint32_t length);
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Smart Sheet - Pseudo-terminal transport
+ * Opens a PTY pair and serves the SPP protocol on it, so host tools
+ * (upload_library.py, terminal programs) talk to the simulator exactly as
+ * they would to /dev/rfcommN. Commands from a loaded script
+ * (hal/sim/script.h) are fed in ahead of PTY input.
+ */
+
+#include "../transport.h"
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../native/fd_link.h"
+#include "../clock.h"
+#include "script.h"
+
+static FdLink ptyLink;
+bool PtyTransport::muted = false;
+static unsigned long arrival = 0;
+static bool arriving = false;      // Bytes of the next line seen, arrival stamped
+static const char* from = NULL;
+static const char* linkPath = NULL;
+static int slaveFd = -1;
+
+void PtyTransport::setLinkPath(const char* path) {
+  linkPath = path;
+}
+
+bool PtyTransport::begin(const char* name) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    Serial.println("PTY: open failed");
+    return false;
+  }
+  const char* slavePath = ptsname(master);
+
+  // Holding the slave open keeps the master readable between client
+  // sessions; raw mode stops the line discipline echoing or rewriting bytes
+  slaveFd = open(slavePath, O_RDWR | O_NOCTTY);
+  if (slaveFd < 0) {
+    Serial.println("PTY: slave open failed");
+    return false;
+  }
+  struct termios mode;
+  tcgetattr(slaveFd, &mode);
+  cfmakeraw(&mode);
+  tcsetattr(slaveFd, TCSANOW, &mode);
+
+  if (linkPath) {
+    unlink(linkPath);
+    if (symlink(slavePath, linkPath) != 0) {
+      Serial.printf("PTY: cannot link %s\n", linkPath);
+      linkPath = NULL;
+    }
+  }
+
+  ptyLink.attach(master, master);
+  Serial.printf("PTY transport: %s on %s%s%s\n", name, slavePath,
+                linkPath ? " -> " : "", linkPath ? linkPath : "");
+  return true;
+}
+
+// Scripted commands come first so they land on their exact tick
+bool PtyTransport::poll(String& command) {
+  if (nextScriptCommand(SimClock::millis(), command)) {
+    from = "SCRIPT";
+    arrival = Clock::micros();
+    Serial.print("Script Command: ");
+    Serial.println(command);
+    return true;
+  }
+  from = ptyLink.available() > 0 ? "PTY" : NULL;
+  if (!arriving && ptyLink.available() > 0) {
+    arrival = Clock::micros();
+    arriving = true;
+  }
+  if (!ptyLink.pollLine(command)) {
+    return false;
+  }
+  arriving = false;
+  Serial.print("PTY Received: ");
+  Serial.println(command);
+  return true;
+}
+
+unsigned long PtyTransport::arrivalMicros() {
+  return arrival;
+}
+
+const char* PtyTransport::source() {
+  return from;
+}
+
+void PtyTransport::send(const String& line) {
+  if (muted) {
+    return;
+  }
+  ptyLink.println(line);
+}
+
+int PtyTransport::txQueued() {
+  return ptyLink.queued();
+}
+
+Stream& PtyTransport::link() {
+  return ptyLink;
+}
+
+// A PTY has no connection state; the simulator runs until stopped
+bool PtyTransport::connected() {
+  return true;
+}
+
+void PtyTransport::end() {
+  if (linkPath) {
+    unlink(linkPath);
+  }
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Smart Sheet - Simulator command script
+ */
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+
+#include "script.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct ScriptCommand {
+  unsigned long at;                          // Simulated ms
+  std::string command;
+};
+
+// ==================== GLOBAL VARIABLES ====================
+static std::vector<ScriptCommand> script;
+static size_t nextCommand = 0;
+static bool loaded = false;
+
+// ==================== LOADING ====================
+bool loadScript(const char* path, int& errorLine) {
+  std::ifstream file(path);
+  errorLine = 0;
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  unsigned long last = 0;
+  while (std::getline(file, line)) {
+    errorLine++;
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+
+    size_t end = line.find_first_of(" \t", start);
+    size_t text = end == std::string::npos ? end : line.find_first_not_of(" \t", end);
+    if (text == std::string::npos) {
+      return false;
+    }
+    std::string stamp = line.substr(start, end - start);
+    if (stamp.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    unsigned long at = strtoul(stamp.c_str(), NULL, 10);
+    if (at < last) {
+      return false;
+    }
+    last = at;
+
+    size_t stop = line.find_last_not_of(" \t\r");
+    script.push_back({at, line.substr(text, stop + 1 - text)});
+  }
+
+  errorLine = 0;
+  loaded = true;
+  return true;
+}
+
+// ==================== REPLAY ====================
+// Hands out at most one due command per call, like a line from the link
+bool nextScriptCommand(unsigned long now, String& command) {
+  if (nextCommand >= script.size() || script[nextCommand].at > now) {
+    return false;
+  }
+  command = String(script[nextCommand].command);
+  nextCommand++;
+  return true;
+}
+
+bool isScriptFinished() {
+  return loaded && nextCommand >= script.size();
+}
+
+#endif
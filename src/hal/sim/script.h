@@ -0,0 +1,26 @@
+/*
+ * Smart Sheet - Simulator command script
+ * Replays commands at fixed simulated times, so a script plus a step size
+ * reproduces the same duty trace bit for bit on every run.
+ *
+ * One command per line, prefixed by its time in simulated milliseconds:
+ *
+ *   0     MODE:WAVE
+ *   250   SPEED:50
+ *   2000  INTENSITY:200
+ *
+ * Times must not decrease. Blank lines and lines starting with # are
+ * skipped.
+ */
+
+#ifndef SMARTSHEET_SIM_SCRIPT_H
+#define SMARTSHEET_SIM_SCRIPT_H
+
+#include <Arduino.h>
+
+// ==================== FUNCTION DECLARATIONS ====================
+bool loadScript(const char* path, int& errorLine);
+bool nextScriptCommand(unsigned long now, String& command);
+bool isScriptFinished();
+
+#endif
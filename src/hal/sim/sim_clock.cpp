@@ -0,0 +1,36 @@
+/*
+ * Smart Sheet - Simulated clock
+ * Time stands still until the simulator advances it, so a run's duty
+ * trace depends only on the commands and the step size
+ */
+
+#include "../clock.h"
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+#include <chrono>
+
+static uint64_t simMicros = 0;
+static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+unsigned long SimClock::millis() {
+  return simMicros / 1000;
+}
+
+unsigned long SimClock::micros() {
+  return simMicros;
+}
+
+// Benchmarks still measure real work, in host nanoseconds
+uint32_t SimClock::cycles() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - origin).count();
+}
+
+uint64_t SimClock::nowMicros() {
+  return simMicros;
+}
+
+void SimClock::advance(uint32_t us) {
+  simMicros += us;
+}
+#endif
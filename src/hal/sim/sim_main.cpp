@@ -0,0 +1,146 @@
+/*
+ * Smart Sheet - Firmware simulator
+ * Runs the unmodified firmware on Linux against simulated time: commands
+ * arrive on a PTY, loop() runs once per time step, and every duty change
+ * the motor driver commits is written to a VCD and/or CSV trace.
+ *
+ *   smartsheet_sim [--vcd FILE] [--csv FILE] [--link PATH] [--script FILE]
+ *                  [--step-us N] [--speed X] [--duration-ms N]
+ *
+ * --speed is simulated time per real time (1 = real time, 0 = as fast as
+ * possible); --duration-ms stops the run after that much simulated time.
+ * A --script run (hal/sim/script.h) without a duration stops after its
+ * last command; otherwise the simulator runs until SIGINT.
+ *
+ * Pattern engines only see time through the now passed down from loop(),
+ * so a scripted run with no PTY input is deterministic: the same script
+ * and step size give a byte-identical trace, and traces from before and
+ * after a refactor can be compared with cmp. tools/golden_traces.py
+ * replays the scripts in test/golden and checks them against the traces
+ * checked in beside them.
+ */
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "../clock.h"
+#include "../transport.h"
+#include "../../config.h"
+#include "trace.h"
+#include "script.h"
+
+void setup();
+void loop();
+
+// ==================== CONFIGURATION ====================
+const uint32_t SIM_DEFAULT_STEP_US = 1000;
+
+struct SimOptions {
+  const char* vcdPath = NULL;
+  const char* csvPath = NULL;
+  const char* linkPath = NULL;
+  const char* scriptPath = NULL;
+  uint32_t stepUs = SIM_DEFAULT_STEP_US;
+  double speed = 1.0;
+  uint64_t durationMs = 0;                   // 0 = until SIGINT
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+static void printUsage(const char* program) {
+  fprintf(stderr, "usage: %s [--vcd FILE] [--csv FILE] [--link PATH] [--script FILE] "
+                  "[--step-us N] [--speed X] [--duration-ms N]\n", program);
+}
+
+static bool parseOptions(int argc, char** argv, SimOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!value) {
+      return false;
+    }
+    if (strcmp(arg, "--vcd") == 0) {
+      options.vcdPath = value;
+    }
+    else if (strcmp(arg, "--csv") == 0) {
+      options.csvPath = value;
+    }
+    else if (strcmp(arg, "--link") == 0) {
+      options.linkPath = value;
+    }
+    else if (strcmp(arg, "--script") == 0) {
+      options.scriptPath = value;
+    }
+    else if (strcmp(arg, "--step-us") == 0) {
+      options.stepUs = strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "--speed") == 0) {
+      options.speed = atof(value);
+    }
+    else if (strcmp(arg, "--duration-ms") == 0) {
+      options.durationMs = strtoull(value, NULL, 10);
+    }
+    else {
+      return false;
+    }
+    i++;
+  }
+  return options.stepUs > 0 && options.speed >= 0;
+}
+
+// ==================== ENTRY POINT ====================
+int main(int argc, char** argv) {
+  SimOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  int errorLine = 0;
+  if (options.scriptPath && !loadScript(options.scriptPath, errorLine)) {
+    fprintf(stderr, "Cannot load script %s (line %d)\n", options.scriptPath, errorLine);
+    return 1;
+  }
+  if (!openTrace(options.vcdPath, options.csvPath, NUM_MOTORS)) {
+    fprintf(stderr, "Cannot open trace file\n");
+    return 1;
+  }
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  PtyTransport::setLinkPath(options.linkPath);
+  setup();
+
+  // Paced runs hold each step to its real-time share, measured against an
+  // absolute schedule so slow steps do not accumulate drift
+  auto start = std::chrono::steady_clock::now();
+  uint64_t limitUs = options.durationMs * 1000;
+  while (!stopRequested && (limitUs == 0 || SimClock::nowMicros() < limitUs)) {
+    loop();
+    if (limitUs == 0 && isScriptFinished()) {
+      break;
+    }
+    SimClock::advance(options.stepUs);
+    if (options.speed > 0) {
+      auto due = start + std::chrono::microseconds(
+        (uint64_t)(SimClock::nowMicros() / options.speed));
+      std::this_thread::sleep_until(due);
+    }
+  }
+
+  closeTrace();
+  PtyTransport::end();
+  fprintf(stderr, "Simulated %llu ms, %u duty changes\n",
+          (unsigned long long)(SimClock::nowMicros() / 1000), getTraceEvents());
+  return 0;
+}
+
+#endif
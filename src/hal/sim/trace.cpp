@@ -0,0 +1,93 @@
+/*
+ * Smart Sheet - Simulator duty trace
+ */
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+
+#include "trace.h"
+#include <stdio.h>
+#include "../clock.h"
+
+// ==================== GLOBAL VARIABLES ====================
+static FILE* vcd = NULL;
+static FILE* csv = NULL;
+static uint64_t lastStamp = UINT64_MAX;
+static uint32_t events = 0;
+
+// VCD identifiers are single printable characters from '!'
+static inline char signalId(int motor) {
+  return '!' + motor;
+}
+
+static void writeVcdValue(int motor, uint8_t duty) {
+  char bits[9];
+  for (int b = 0; b < 8; b++) {
+    bits[b] = (duty >> (7 - b)) & 1 ? '1' : '0';
+  }
+  bits[8] = '\0';
+  fprintf(vcd, "b%s %c\n", bits, signalId(motor));
+}
+
+// ==================== TRACE FILES ====================
+bool openTrace(const char* vcdPath, const char* csvPath, int motors) {
+  if (vcdPath) {
+    vcd = fopen(vcdPath, "w");
+    if (!vcd) {
+      return false;
+    }
+    fprintf(vcd, "$version Smart Sheet simulator $end\n");
+    fprintf(vcd, "$timescale 1us $end\n");
+    fprintf(vcd, "$scope module smartsheet $end\n");
+    for (int m = 0; m < motors; m++) {
+      fprintf(vcd, "$var wire 8 %c motor%d [7:0] $end\n", signalId(m), m + 1);
+    }
+    fprintf(vcd, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+    for (int m = 0; m < motors; m++) {
+      writeVcdValue(m, 0);
+    }
+    fprintf(vcd, "$end\n");
+    lastStamp = 0;
+  }
+  if (csvPath) {
+    csv = fopen(csvPath, "w");
+    if (!csv) {
+      return false;
+    }
+    fprintf(csv, "time_us,motor,duty\n");
+  }
+  return true;
+}
+
+void traceDuty(int motor, uint8_t duty) {
+  uint64_t now = SimClock::nowMicros();
+  events++;
+  if (vcd) {
+    if (now != lastStamp) {
+      fprintf(vcd, "#%llu\n", (unsigned long long)now);
+      lastStamp = now;
+    }
+    writeVcdValue(motor, duty);
+  }
+  if (csv) {
+    fprintf(csv, "%llu,%d,%u\n", (unsigned long long)now, motor + 1, duty);
+  }
+}
+
+void closeTrace() {
+  if (vcd) {
+    // Close the last interval so viewers show the final values
+    fprintf(vcd, "#%llu\n", (unsigned long long)SimClock::nowMicros());
+    fclose(vcd);
+    vcd = NULL;
+  }
+  if (csv) {
+    fclose(csv);
+    csv = NULL;
+  }
+}
+
+uint32_t getTraceEvents() {
+  return events;
+}
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Smart Sheet - Simulator duty trace
+ * Records every committed duty change against simulated time, as a VCD
+ * file (one 8-bit signal per motor, for GTKWave) and/or a CSV of
+ * time_us,motor,duty rows.
+ */
+
+#ifndef SMARTSHEET_SIM_TRACE_H
+#define SMARTSHEET_SIM_TRACE_H
+
+#include <stdint.h>
+
+// ==================== FUNCTION DECLARATIONS ====================
+bool openTrace(const char* vcdPath, const char* csvPath, int motors);
+void traceDuty(int motor, uint8_t duty);
+void closeTrace();
+uint32_t getTraceEvents();
+
+#endif
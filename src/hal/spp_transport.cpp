@@ -0,0 +1,12 @@
+/*
+ * Smart Sheet - Bluetooth SPP transport storage
+ */
+
+#include "transport.h"
+
+#if !defined(NATIVE_BUILD)
+BluetoothSerial SerialBT;
+unsigned long SppTransport::arrival = 0;
+const char* SppTransport::from = NULL;
+bool SppTransport::muted = false;
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Smart Sheet - Stdio transport
+ * Commands arrive as lines on stdin and replies go to stdout. Input is
+ * polled without blocking so loop() keeps running between commands.
+ */
+
+#include "transport.h"
+
+#if defined(NATIVE_BUILD) && !defined(SIMULATOR)
+#include <unistd.h>
+#include "native/fd_link.h"
+
+static FdLink stdioLink;
+bool StdioTransport::muted = false;
+static unsigned long arrival = 0;
+static bool arriving = false;      // Bytes of the next line seen, arrival stamped
+static const char* from = NULL;
+
+bool StdioTransport::begin(const char* name) {
+  stdioLink.attach(STDIN_FILENO, STDOUT_FILENO);
+  Serial.printf("Stdio transport: %s\n", name);
+  return true;
+}
+
+bool StdioTransport::poll(String& command) {
+  from = stdioLink.available() > 0 ? "STDIN" : NULL;
+  if (!arriving && stdioLink.available() > 0) {
+    arrival = Clock::micros();
+    arriving = true;
+  }
+  if (!stdioLink.pollLine(command)) {
+    return false;
+  }
+  arriving = false;
+  Serial.print("Stdin Received: ");
+  Serial.println(command);
+  return true;
+}
+
+unsigned long StdioTransport::arrivalMicros() {
+  return arrival;
+}
+
+const char* StdioTransport::source() {
+  return from;
+}
+
+void StdioTransport::send(const String& line) {
+  if (muted) {
+    return;
+  }
+  stdioLink.println(line);
+}
+
+int StdioTransport::txQueued() {
+  return stdioLink.queued();
+}
+
+Stream& StdioTransport::link() {
+  return stdioLink;
+}
+
+bool StdioTransport::connected() {
+  return stdioLink.isOpen();
+}
+#endif
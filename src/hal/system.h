@@ -0,0 +1,74 @@
+/*
+ * Smart Sheet - System introspection
+ * Heap and task figures for PERF, selected at compile time like the clock:
+ *
+ *   static uint32_t freeHeap();
+ *   static uint32_t largestFreeBlock();
+ *   static uint32_t minFreeHeap();          - low-water mark since boot
+ *   static int taskStats(TaskStat* stats, int max, uint32_t& runTimeTotal);
+ *   static const void* currentTask();       - identifies the calling task
+ *   static size_t allocatedSize(void* block) - usable size of a malloc block
+ *
+ * taskStats() fills up to max entries and returns how many it filled.
+ * Run-time counters are raw and cumulative; callers take differences to
+ * get a CPU share over an interval. Native builds have no bounded heap or
+ * FreeRTOS scheduler and report zeros and no tasks.
+ */
+
+#ifndef SMARTSHEET_SYSTEM_H
+#define SMARTSHEET_SYSTEM_H
+
+#include <Arduino.h>
+
+#if defined(NATIVE_BUILD)
+#include <malloc.h>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#endif
+
+struct TaskStat {
+  const void* id;                    // Stable while the task lives
+  const char* name;
+  uint32_t stackFree;                // Stack bytes never touched
+  uint32_t runTime;                  // 0 when run-time stats are disabled
+};
+
+#if defined(NATIVE_BUILD)
+
+struct HostSystem {
+  static uint32_t freeHeap() { return 0; }
+  static uint32_t largestFreeBlock() { return 0; }
+  static uint32_t minFreeHeap() { return 0; }
+  static int taskStats(TaskStat* stats, int max, uint32_t& runTimeTotal) {
+    (void)stats;
+    (void)max;
+    runTimeTotal = 0;
+    return 0;
+  }
+  static const void* currentTask() {
+    static thread_local char marker;
+    return &marker;
+  }
+  static size_t allocatedSize(void* block) { return malloc_usable_size(block); }
+};
+
+typedef HostSystem System;
+
+#else
+
+struct EspSystem {
+  static inline uint32_t freeHeap() { return ESP.getFreeHeap(); }
+  static inline uint32_t largestFreeBlock() { return ESP.getMaxAllocHeap(); }
+  static inline uint32_t minFreeHeap() { return ESP.getMinFreeHeap(); }
+  static int taskStats(TaskStat* stats, int max, uint32_t& runTimeTotal);
+  static inline const void* currentTask() { return xTaskGetCurrentTaskHandle(); }
+  static inline size_t allocatedSize(void* block) { return heap_caps_get_allocated_size(block); }
+};
+
+typedef EspSystem System;
+
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Smart Sheet - Command transport
+ * The text command link, selected at compile time:
+ *
+ *   static bool begin(const char* name);
+ *   static bool poll(String& command);    - next complete line, if any
+ *   static unsigned long arrivalMicros(); - when that line's bytes were first seen
+ *   static const char* source();          - link the last poll() read, NULL if none
+ *   static void send(const String& line); - reply on every link
+ *   static Stream& link();                - raw byte link for bulk uploads
+ *   static bool connected();
+ *   static int txQueued();                - reply bytes not yet sent
+ *   static bool muted;                    - drop replies while set
+ *
+ * The ESP32 build takes commands from Bluetooth SPP and the USB serial
+ * console and answers on both. Native builds (-D NATIVE_BUILD) use
+ * stdin/stdout, with Serial logging to stderr. The simulator (-D SIMULATOR)
+ * serves the SPP protocol on a pseudo-terminal instead.
+ *
+ * Benchmarks set muted while they drive the command parser, so timing
+ * runs do not flood the link with replies.
+ */
+
+#ifndef SMARTSHEET_TRANSPORT_H
+#define SMARTSHEET_TRANSPORT_H
+
+#include <Arduino.h>
+#include "clock.h"
+
+#if defined(NATIVE_BUILD) && defined(SIMULATOR)
+
+struct PtyTransport {
+  static void setLinkPath(const char* path);  // Symlink to the slave, before begin()
+  static bool begin(const char* name);
+  static bool poll(String& command);
+  static unsigned long arrivalMicros();
+  static const char* source();
+  static void send(const String& line);
+  static Stream& link();
+  static bool connected();
+  static int txQueued();
+  static void end();                          // Removes the symlink
+  static bool muted;
+};
+
+typedef PtyTransport Transport;
+
+#elif defined(NATIVE_BUILD)
+
+struct StdioTransport {
+  static bool begin(const char* name);
+  static bool poll(String& command);
+  static unsigned long arrivalMicros();
+  static const char* source();
+  static void send(const String& line);
+  static Stream& link();
+  static bool connected();
+  static int txQueued();
+  static bool muted;
+};
+
+typedef StdioTransport Transport;
+
+#else
+
+#include "BluetoothSerial.h"
+#include "soc/soc_caps.h"
+
+// Check if Bluetooth is enabled
+#if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
+#error Bluetooth is not enabled! Please run `make menuconfig` and enable it
+#endif
+
+extern BluetoothSerial SerialBT;
+
+struct SppTransport {
+  static bool begin(const char* name) {
+    return SerialBT.begin(name);
+  }
+
+  // Lines are read whole, so arrival is when poll() first sees bytes
+  static bool poll(String& command) {
+    from = NULL;
+    if (SerialBT.available()) {
+      from = "BT";
+      arrival = Clock::micros();
+      command = SerialBT.readStringUntil('\n');
+      command.trim();
+      if (command.length() > 0) {
+        Serial.print("BT Received: ");
+        Serial.println(command);
+        return true;
+      }
+    }
+    
+    // Serial Monitor commands (for debugging)
+    if (Serial.available()) {
+      from = "SERIAL";
+      arrival = Clock::micros();
+      command = Serial.readStringUntil('\n');
+      command.trim();
+      if (command.length() > 0) {
+        Serial.print("Serial Received: ");
+        Serial.println(command);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static inline unsigned long arrivalMicros() {
+    return arrival;
+  }
+
+  static inline const char* source() {
+    return from;
+  }
+
+  static inline void send(const String& line) {
+    if (muted) {
+      return;
+    }
+    Serial.println(line);
+    SerialBT.println(line);
+  }
+
+  static inline Stream& link() {
+    return SerialBT;
+  }
+
+  static inline bool connected() {
+    return SerialBT.hasClient();
+  }
+
+  // BluetoothSerial does not expose its send queue; send() also blocks on
+  // the USB console mirror, so its UART backlog is what is reported
+  static inline int txQueued() {
+    int queued = SOC_UART_FIFO_LEN - (int)Serial.availableForWrite();
+    return queued > 0 ? queued : 0;
+  }
+
+  static unsigned long arrival;
+  static const char* from;
+  static bool muted;
+};
+
+typedef SppTransport Transport;
+
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+/*
+ * Smart Sheet - Heap allocation tracking
+ * The --wrap linker flags send every malloc/calloc/realloc/free reference
+ * in the image here; __real_* reach the allocator. Only plain-old-data
+ * statics are used, since allocations can arrive before constructors run.
+ */
+
+#include "heap_track.h"
+
+#if defined(HEAP_TRACKING)
+#include <new>
+#include "freertos/FreeRTOS.h"
+#include "hal/system.h"
+
+// ==================== GLOBAL VARIABLES ====================
+const char* heapSiteTag = "boot";
+
+static portMUX_TYPE heapLock = portMUX_INITIALIZER_UNLOCKED;
+static HeapStats heap;
+static HeapSiteStats sites[HEAP_SITES];
+static int siteCount = 0;
+static const void* loopTask = NULL;
+static bool armed = false;
+
+#if defined(HEAP_GUARD)
+static HeapSiteStats lastViolation;
+static uint32_t reported = 0;
+#endif
+
+// ==================== RECORDING ====================
+static void heapAllocated(void* block, const void* caller) {
+  uint32_t size = System::allocatedSize(block);
+  const void* task = System::currentTask();
+  bool onLoop = loopTask == NULL || task == loopTask;
+  const char* tag = onLoop ? heapSiteTag : "task";
+
+  portENTER_CRITICAL(&heapLock);
+  heap.allocs++;
+  heap.live += size;
+  if (heap.live > heap.peak) {
+    heap.peak = heap.live;
+  }
+
+  int s = 0;
+  while (s < siteCount && (sites[s].tag != tag || sites[s].caller != caller)) {
+    s++;
+  }
+  if (s == siteCount && siteCount < HEAP_SITES) {
+    sites[s].tag = tag;
+    sites[s].caller = caller;
+    sites[s].count = 0;
+    sites[s].bytes = 0;
+    siteCount++;
+  }
+  if (s < siteCount) {
+    sites[s].count++;
+    sites[s].bytes += size;
+  }
+  else {
+    heap.dropped++;
+  }
+
+  if (armed && onLoop) {
+    heap.afterBoot++;
+#if defined(HEAP_GUARD)
+    lastViolation.tag = tag;
+    lastViolation.caller = caller;
+    lastViolation.bytes = size;
+#endif
+  }
+  portEXIT_CRITICAL(&heapLock);
+}
+
+static void heapFreed(uint32_t size) {
+  portENTER_CRITICAL(&heapLock);
+  heap.frees++;
+  heap.live -= size < heap.live ? size : heap.live;
+  portEXIT_CRITICAL(&heapLock);
+}
+
+// ==================== ALLOCATOR WRAPPERS ====================
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* block, size_t size);
+void __real_free(void* block);
+
+void* __wrap_malloc(size_t size) {
+  void* block = __real_malloc(size);
+  if (block) {
+    heapAllocated(block, __builtin_return_address(0));
+  }
+  return block;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  void* block = __real_calloc(count, size);
+  if (block) {
+    heapAllocated(block, __builtin_return_address(0));
+  }
+  return block;
+}
+
+// A String growing in place still counts as an allocation: it is the
+// churn that fragments the heap
+void* __wrap_realloc(void* block, size_t size) {
+  uint32_t old = block ? System::allocatedSize(block) : 0;
+  void* moved = __real_realloc(block, size);
+  if (moved) {
+    if (block) {
+      heapFreed(old);
+    }
+    heapAllocated(moved, __builtin_return_address(0));
+  }
+  else if (block && size == 0) {
+    heapFreed(old);
+  }
+  return moved;
+}
+
+void __wrap_free(void* block) {
+  if (block) {
+    heapFreed(System::allocatedSize(block));
+  }
+  __real_free(block);
+}
+
+}
+
+#if defined(NATIVE_BUILD)
+// The host's libstdc++ is a shared library whose malloc calls the linker
+// cannot wrap, so new/delete are replaced here and record the code that
+// called new. On the ESP32 it is linked statically and already covered.
+void* operator new(size_t size) {
+  void* block = __real_malloc(size ? size : 1);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  heapAllocated(block, __builtin_return_address(0));
+  return block;
+}
+
+void* operator new[](size_t size) {
+  void* block = __real_malloc(size ? size : 1);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  heapAllocated(block, __builtin_return_address(0));
+  return block;
+}
+
+void operator delete(void* block) noexcept {
+  free(block);
+}
+
+void operator delete[](void* block) noexcept {
+  free(block);
+}
+
+void operator delete(void* block, size_t size) noexcept {
+  (void)size;
+  free(block);
+}
+
+void operator delete[](void* block, size_t size) noexcept {
+  (void)size;
+  free(block);
+}
+#endif
+
+// ==================== PUBLIC API ====================
+void startHeapTracking() {
+  loopTask = System::currentTask();
+}
+
+void armHeapGuard() {
+  heapSiteTag = "loop";
+  armed = true;
+}
+
+void checkHeapGuard() {
+#if defined(HEAP_GUARD)
+  HeapSite site("guard");
+  HeapSiteStats last;
+  uint32_t count;
+
+  portENTER_CRITICAL(&heapLock);
+  count = heap.afterBoot;
+  last = lastViolation;
+  portEXIT_CRITICAL(&heapLock);
+
+  if (count == reported) {
+    return;
+  }
+  // Kept short so printf formats it on the stack
+  Serial.printf("HEAP GUARD: %s %p %u B (%u)\n",
+                last.tag, last.caller, (unsigned)last.bytes, (unsigned)count);
+  reported = heap.afterBoot;
+#endif
+}
+
+HeapStats getHeapStats() {
+  portENTER_CRITICAL(&heapLock);
+  HeapStats stats = heap;
+  portEXIT_CRITICAL(&heapLock);
+  return stats;
+}
+
+int getHeapSites(HeapSiteStats* copy, int max) {
+  portENTER_CRITICAL(&heapLock);
+  int count = siteCount < max ? siteCount : max;
+  memcpy(copy, sites, count * sizeof(HeapSiteStats));
+  portEXIT_CRITICAL(&heapLock);
+  return count;
+}
+
+void resetHeapStats() {
+  portENTER_CRITICAL(&heapLock);
+  uint32_t live = heap.live;
+  memset(&heap, 0, sizeof(heap));
+  heap.live = live;
+  heap.peak = live;
+  siteCount = 0;
+#if defined(HEAP_GUARD)
+  reported = 0;
+#endif
+  portEXIT_CRITICAL(&heapLock);
+}
+
+#endif
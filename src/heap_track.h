@@ -0,0 +1,81 @@
+/*
+ * Smart Sheet - Heap allocation tracking
+ * Debug builds only (-D HEAP_TRACKING, linked with -Wl,--wrap=malloc and
+ * friends - see [env:esp32dev_heap]). malloc/calloc/realloc/free go through
+ * counting wrappers that keep live and peak bytes plus a small table of
+ * allocation sites. A site is the innermost HeapSite tag active on the
+ * loop task ("input", "command", "pattern", ...) together with the code
+ * address that called the allocator; allocations from other tasks (the
+ * Bluetooth stack, the cycle cache worker) are filed under "task".
+ *
+ * Every loop-task allocation after armHeapGuard() (end of setup()) is also
+ * counted as AFTER_BOOT, so a steady-state run should leave it at 0. With
+ * -D HEAP_GUARD as well, checkHeapGuard() reports each new one on the
+ * console as it happens. The wrappers never print themselves.
+ *
+ * HEAP replies with a summary line followed by one line per site:
+ *
+ *   HEAP:ALLOCS:<n>,FREES:<n>,LIVE:<bytes>,PEAK:<bytes>,AFTER_BOOT:<n>,SITES:<n>/<dropped>
+ *   HEAP:SITE:<tag>:<caller hex>:<count>:<bytes>
+ *
+ * Without HEAP_TRACKING the HeapSite scopes and hooks compile to nothing.
+ */
+
+#ifndef SMARTSHEET_HEAP_TRACK_H
+#define SMARTSHEET_HEAP_TRACK_H
+
+#include <Arduino.h>
+
+const int HEAP_SITES = 32;
+
+#if defined(HEAP_TRACKING)
+
+struct HeapStats {
+  uint32_t allocs;                   // malloc/calloc/realloc that returned a block
+  uint32_t frees;
+  uint32_t live;                     // Bytes currently allocated through the wrappers
+  uint32_t peak;
+  uint32_t afterBoot;                // Loop-task allocations since armHeapGuard()
+  uint32_t dropped;                  // Allocations whose site did not fit the table
+};
+
+struct HeapSiteStats {
+  const char* tag;
+  const void* caller;
+  uint32_t count;
+  uint32_t bytes;
+};
+
+extern const char* heapSiteTag;
+
+// Tags loop-task allocations made while it is in scope
+class HeapSite {
+public:
+  explicit HeapSite(const char* tag) : outer(heapSiteTag) { heapSiteTag = tag; }
+  ~HeapSite() { heapSiteTag = outer; }
+
+private:
+  const char* outer;
+};
+
+void startHeapTracking();            // Start of setup(), on the loop task
+void armHeapGuard();                 // End of setup()
+void checkHeapGuard();               // Once per loop()
+HeapStats getHeapStats();
+int getHeapSites(HeapSiteStats* sites, int max);
+void resetHeapStats();
+
+#else
+
+class HeapSite {
+public:
+  explicit HeapSite(const char* tag) { (void)tag; }
+};
+
+static inline void startHeapTracking() {}
+static inline void armHeapGuard() {}
+static inline void checkHeapGuard() {}
+
+#endif
+
+#endif
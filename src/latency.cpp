@@ -0,0 +1,78 @@
+/*
+ * Smart Sheet - Command latency tracing
+ */
+
+#include "latency.h"
+#include "pipeline.h"
+
+// ==================== GLOBAL VARIABLES ====================
+static PerfHistogram rxStage;
+static PerfHistogram execStage;
+static PerfHistogram outputStage;
+static PerfHistogram totalStage;
+
+// The command waiting for its first output commit
+static bool pending = false;
+static unsigned long pendingArrival;
+static unsigned long pendingApplied;
+static uint32_t pendingCommits;
+
+// ==================== RECORDING ====================
+void resetLatency() {
+  memset(&rxStage, 0, sizeof(rxStage));
+  memset(&execStage, 0, sizeof(execStage));
+  memset(&outputStage, 0, sizeof(outputStage));
+  memset(&totalStage, 0, sizeof(totalStage));
+  pending = false;
+}
+
+static void recordCommit(unsigned long committedUs) {
+  perfRecord(outputStage, committedUs - pendingApplied);
+  perfRecord(totalStage, committedUs - pendingArrival);
+  pending = false;
+}
+
+void latencyCommand(unsigned long arrivalUs, unsigned long lineUs, unsigned long appliedUs,
+                    bool affectsOutput, uint32_t commitsAtLine) {
+  perfRecord(rxStage, lineUs - arrivalUs);
+  perfRecord(execStage, appliedUs - lineUs);
+  if (!affectsOutput) {
+    return;
+  }
+
+  pending = true;
+  pendingArrival = arrivalUs;
+  pendingApplied = appliedUs;
+  pendingCommits = commitsAtLine;
+
+  // Some commands (MODE:STOP) commit while they are applied
+  if (outputCommits != commitsAtLine) {
+    recordCommit(appliedUs);
+  }
+}
+
+void latencyTick(unsigned long nowUs) {
+  if (!pending) {
+    return;
+  }
+  if (outputCommits != pendingCommits) {
+    recordCommit(nowUs);
+  }
+  else if (nowUs - pendingApplied > LATENCY_COMMIT_TIMEOUT_MS * 1000) {
+    pending = false;
+  }
+}
+
+// ==================== FORMATTING ====================
+static String formatStage(const char* name, const PerfHistogram& stage) {
+  return String(name) + ":" + String(stage.samples) + "/" + 
+         String(stage.samples ? (uint32_t)(stage.sum / stage.samples) : 0) + "/" + 
+         String(stage.max) + "/" + formatPerfHistogram(stage);
+}
+
+String formatLatency() {
+  return "LATENCY:" + formatStage("RX", rxStage) + 
+         "," + formatStage("EXEC", execStage) + 
+         "," + formatStage("OUTPUT", outputStage) + 
+         "," + formatStage("TOTAL", totalStage);
+}
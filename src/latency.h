@@ -0,0 +1,37 @@
+/*
+ * Smart Sheet - Command latency tracing
+ * Every command is stamped on the device's microsecond clock at four
+ * points:
+ *
+ *   arrival    transport first sees the line's bytes
+ *   line       the complete line is handed to the command processor
+ *   applied    processCommand() returns: state changed, reply sent
+ *   committed  the first pipeline run after it that changed a duty
+ *
+ * and each gap goes into a log2 histogram (see perf.h): RX (arrival to
+ * line, i.e. waiting on loop()), EXEC (parse, apply and reply), OUTPUT
+ * (waiting for the next pattern tick) and TOTAL (arrival to committed).
+ * Queries have no output stage. One command is followed to its commit at
+ * a time; a newer command takes over the slot, and one with no commit
+ * within LATENCY_COMMIT_TIMEOUT_MS (e.g. a rejected value) is dropped.
+ *
+ * LATENCY replies LATENCY:<stage>:<count>/<avg us>/<max us>/<histogram>,...
+ * and PERF:RESET clears the histograms with the other counters.
+ */
+
+#ifndef SMARTSHEET_LATENCY_H
+#define SMARTSHEET_LATENCY_H
+
+#include <Arduino.h>
+#include "perf.h"
+
+const unsigned long LATENCY_COMMIT_TIMEOUT_MS = 2000;
+
+// ==================== FUNCTION DECLARATIONS ====================
+void resetLatency();
+void latencyCommand(unsigned long arrivalUs, unsigned long lineUs, unsigned long appliedUs,
+                    bool affectsOutput, uint32_t commitsAtLine);
+void latencyTick(unsigned long nowUs);
+String formatLatency();
+
+#endif
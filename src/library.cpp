@@ -0,0 +1,248 @@
+/*
+ * Smart Sheet - Flash pattern library
+ * Partition mapping, index validation and FRAMES playback
+ */
+
+#include "library.h"
+#include "sequencer.h"
+
+// ==================== GLOBAL VARIABLES ====================
+static const esp_partition_t* partition = NULL;
+static spi_flash_mmap_handle_t mapHandle;
+static const uint8_t* image = NULL;
+static const LibraryHeader* header = NULL;
+static const LibraryEntry* entries = NULL;
+
+struct LibraryPlayer {
+  const LibraryEntry* entry;
+  const uint8_t* row;                        // FRAMES: current row in flash
+  int frame;
+  unsigned long lastStep;
+  bool playing;
+  FrameDecoder decoder;                      // FRAMES_LZ: stream state
+  uint8_t decoded[MOTOR_BANK_MAX];           // FRAMES_LZ: current row
+};
+
+static LibraryPlayer player;
+
+static const char* KIND_NAMES[] = {"FRAMES", "TRACK", "LZ"};
+
+// ==================== MOUNTING ====================
+// Tracks play in place, so every record must pass the checks addKeyframe()
+// applies to RAM tracks
+static bool validTrack(const Keyframe* keys, int count) {
+  for (int k = 0; k < count; k++) {
+    if (!validKeyframe(keys[k], keys, k)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rejects the whole image if any entry points outside it or holds a
+// malformed track, so playback never needs to bounds-check flash reads and
+// every track loop consumes time
+static bool validateImage(uint32_t partitionSize) {
+  if (header->magic != LIBRARY_MAGIC || header->version != LIBRARY_VERSION) {
+    return false;
+  }
+  uint32_t indexEnd = sizeof(LibraryHeader) + (uint32_t)header->count * sizeof(LibraryEntry);
+  if (header->imageSize > partitionSize || indexEnd > header->imageSize) {
+    return false;
+  }
+
+  for (int k = 0; k < header->count; k++) {
+    const LibraryEntry& entry = entries[k];
+    if (k > 0 && entry.id <= entries[k - 1].id) {
+      return false;
+    }
+    if (entry.offset < indexEnd || entry.offset % 4 != 0 ||
+        entry.length > header->imageSize - entry.offset) {
+      return false;
+    }
+    if (entry.kind > LIB_FRAMES_LZ || entry.frameCount == 0) {
+      return false;
+    }
+    if (entry.kind == LIB_TRACK) {
+      if (entry.length != (uint32_t)entry.frameCount * sizeof(Keyframe) ||
+          entry.frameCount > SEQ_MAX_KEYFRAMES ||
+          !validTrack((const Keyframe*)(image + entry.offset), entry.frameCount)) {
+        return false;
+      }
+      continue;
+    }
+    if (entry.motors == 0 || entry.frameMs == 0) {
+      return false;
+    }
+    // Compressed streams are checked while decoding; rows must fit the
+    // decode buffer
+    if (entry.kind == LIB_FRAMES_LZ ? entry.motors > MOTOR_BANK_MAX || entry.length == 0
+                                    : entry.length != (uint32_t)entry.frameCount * entry.motors) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const esp_partition_t* findLibraryPartition() {
+  return esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  (esp_partition_subtype_t)LIBRARY_PARTITION_SUBTYPE,
+                                  LIBRARY_PARTITION_LABEL);
+}
+
+bool mountLibrary() {
+  unmountLibrary();
+
+  partition = findLibraryPartition();
+  if (partition == NULL) {
+    return false;
+  }
+
+  const void* mapped;
+  if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+                         &mapped, &mapHandle) != ESP_OK) {
+    partition = NULL;
+    return false;
+  }
+
+  image = (const uint8_t*)mapped;
+  header = (const LibraryHeader*)image;
+  entries = (const LibraryEntry*)(image + sizeof(LibraryHeader));
+  if (!validateImage(partition->size)) {
+    unmountLibrary();
+    return false;
+  }
+  return true;
+}
+
+void unmountLibrary() {
+  stopLibraryPlayback();
+  if (image != NULL) {
+    if (sequencerUsesTrack(image, partition->size)) {
+      stopSequence();
+    }
+    spi_flash_munmap(mapHandle);
+  }
+  image = NULL;
+  header = NULL;
+  entries = NULL;
+}
+
+bool isLibraryMounted() {
+  return header != NULL;
+}
+
+// ==================== LOOKUP ====================
+int getLibraryCount() {
+  return header ? header->count : 0;
+}
+
+const LibraryEntry* getLibraryEntry(int index) {
+  if (!header || index < 0 || index >= header->count) {
+    return NULL;
+  }
+  return &entries[index];
+}
+
+// Binary search over the sorted index
+const LibraryEntry* findLibraryEntry(uint16_t id) {
+  if (!header) {
+    return NULL;
+  }
+  int low = 0;
+  int high = header->count - 1;
+  while (low <= high) {
+    int mid = (low + high) >> 1;
+    uint16_t midId = entries[mid].id;
+    if (midId == id) {
+      return &entries[mid];
+    }
+    if (midId < id) {
+      low = mid + 1;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  return NULL;
+}
+
+const uint8_t* libraryRecord(const LibraryEntry& entry) {
+  return image + entry.offset;
+}
+
+const uint8_t* libraryImage() {
+  return image;
+}
+
+const char* libraryKindName(uint8_t kind) {
+  return kind <= LIB_FRAMES_LZ ? KIND_NAMES[kind] : "?";
+}
+
+// ==================== FRAMES PLAYBACK ====================
+static void rewindPlayer() {
+  const LibraryEntry& entry = *player.entry;
+  player.row = libraryRecord(entry);
+  player.frame = 0;
+  if (entry.kind == LIB_FRAMES_LZ) {
+    beginFrameDecode(player.decoder, libraryRecord(entry), entry.length);
+    memset(player.decoded, 0, sizeof(player.decoded));
+  }
+}
+
+bool startLibraryPlayback(const LibraryEntry& entry, unsigned long now) {
+  if (entry.kind == LIB_TRACK) {
+    return false;
+  }
+  player.entry = &entry;
+  rewindPlayer();
+  player.lastStep = now - entry.frameMs;     // First row renders on the next tick
+  player.playing = true;
+  return true;
+}
+
+void stopLibraryPlayback() {
+  player.playing = false;
+  player.entry = NULL;
+}
+
+// Rows are read straight from mapped flash, or decoded from it one row per
+// step; at the end playback loops or holds the last row
+bool libraryTick(unsigned long now, MotorFrame& frame) {
+  if (!player.playing || now - player.lastStep < player.entry->frameMs) {
+    return false;
+  }
+  player.lastStep = now;
+
+  const LibraryEntry& entry = *player.entry;
+  const uint8_t* row = player.row;
+  int motors = entry.motors;
+  if (entry.kind == LIB_FRAMES_LZ) {
+    if (!decodeFrameRow(player.decoder, player.decoded, motors)) {
+      player.playing = false;
+      return false;
+    }
+    row = player.decoded;
+  }
+  bool changed = false;
+  Motors::forEach([&](int i) {
+    uint8_t value = i < motors ? row[i] : 0;
+    if (frame.values[i] != value) {
+      frame.values[i] = value;
+      changed = true;
+    }
+  });
+
+  if (++player.frame < entry.frameCount) {
+    if (entry.kind == LIB_FRAMES) {
+      player.row += motors;
+    }
+  }
+  else if (entry.flags & LIB_FLAG_LOOP) {
+    rewindPlayer();
+  }
+  else {
+    player.playing = false;
+  }
+  return changed;
+}
@@ -0,0 +1,81 @@
+/*
+ * Smart Sheet - Flash pattern library
+ * A dedicated "patterns" data partition holds an index plus records. The
+ * whole partition is memory-mapped once at boot, so records play straight
+ * out of cached flash without being copied to the heap. Images are built
+ * on the host with tools/pack_library.py.
+ *
+ * Image layout (little-endian):
+ *   LibraryHeader
+ *   LibraryEntry[count]      sorted by id
+ *   records                  4-byte aligned
+ *
+ * A FRAMES record is frameCount rows of `motors` intensity bytes, stepped
+ * every frameMs. FRAMES_LZ holds the same rows delta- and LZ-encoded (see
+ * frame_codec.h) and is decoded a row per step. A TRACK record is
+ * frameCount Keyframes (sequencer.h), handed to the sequencer in place.
+ */
+
+#ifndef SMARTSHEET_LIBRARY_H
+#define SMARTSHEET_LIBRARY_H
+
+#include <Arduino.h>
+#include "frame.h"
+#include "frame_codec.h"
+#include "esp_partition.h"
+
+// ==================== LIBRARY FORMAT ====================
+const uint32_t LIBRARY_MAGIC = 0x4C505353;    // "SSPL"
+const uint16_t LIBRARY_VERSION = 1;
+const int LIBRARY_PARTITION_SUBTYPE = 0x40;
+#define LIBRARY_PARTITION_LABEL "patterns"
+
+enum LibraryKind {
+  LIB_FRAMES,
+  LIB_TRACK,
+  LIB_FRAMES_LZ
+};
+
+const uint8_t LIB_FLAG_LOOP = 0x01;
+
+struct LibraryHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t imageSize;                        // Header, index and records
+  uint32_t reserved;
+};
+
+struct LibraryEntry {
+  uint16_t id;
+  uint8_t motors;                            // FRAMES: bytes per row
+  uint8_t kind;                              // LibraryKind
+  uint8_t flags;
+  uint8_t reserved[3];
+  uint16_t frameMs;                          // FRAMES: step time
+  uint16_t frameCount;                       // FRAMES: rows, TRACK: keyframes
+  uint32_t offset;                           // From image start
+  uint32_t length;                           // Bytes
+};
+
+static_assert(sizeof(LibraryHeader) == 16, "Library header must stay 16 bytes");
+static_assert(sizeof(LibraryEntry) == 20, "Library entries must stay 20 bytes");
+
+// ==================== FUNCTION DECLARATIONS ====================
+const esp_partition_t* findLibraryPartition();
+bool mountLibrary();
+void unmountLibrary();
+bool isLibraryMounted();
+int getLibraryCount();
+const LibraryEntry* getLibraryEntry(int index);
+const LibraryEntry* findLibraryEntry(uint16_t id);
+const uint8_t* libraryRecord(const LibraryEntry& entry);
+const uint8_t* libraryImage();
+const char* libraryKindName(uint8_t kind);
+
+// FRAMES and FRAMES_LZ playback
+bool startLibraryPlayback(const LibraryEntry& entry, unsigned long now);
+void stopLibraryPlayback();
+bool libraryTick(unsigned long now, MotorFrame& frame);
+
+#endif
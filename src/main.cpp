@@ -1,61 +1,84 @@
 /*
  * Smart Sheet - ESP32 Bluetooth Motor Controller
- * Controls 8 motors via PWM with pattern support
- * Communication: Bluetooth Classic SPP
+ * Controls up to 16 motors via PWM with pattern support
+ * Communication: Bluetooth Classic SPP (hal/transport.h; stdin/stdout in
+ *                the native host build)
  * 
- * Motor Pins: D18, D19, D21, D22, D23, D25, D26, D27
+ * Motor Pins (default 8-zone bank): D18, D19, D21, D22, D23, D25, D26, D27
+ * Larger banks are selected per build environment, see config.h
  */
 
 #include <Arduino.h>
-#include "BluetoothSerial.h"
-
-// Check if Bluetooth is enabled
-#if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
-#error Bluetooth is not enabled! Please run `make menuconfig` and enable it
-#endif
-
-BluetoothSerial SerialBT;
-
-// ==================== PIN CONFIGURATION ====================
-const int MOTOR_PINS[8] = {18, 19, 21, 22, 23, 25, 26, 27};
-const int NUM_MOTORS = 8;
-
-// ==================== PWM CONFIGURATION ====================
-const int PWM_FREQUENCY = 5000;    // 5 KHz
-const int PWM_RESOLUTION = 8;      // 8-bit resolution (0-255)
-
-// ==================== PATTERN MODES ====================
-enum PatternMode {
-  MODE_STOP,
-  MODE_CONSTANT,
-  MODE_WAVE
-};
+#include "config.h"
+#include "hal/clock.h"
+#include "hal/transport.h"
+#include "calibration.h"
+#include "shaping.h"
+#include "benchmark.h"
+#include "patterns.h"
+#include "mixer.h"
+#include "oscillator.h"
+#include "cycle_cache.h"
+#include "sequencer.h"
+#include "expr.h"
+#include "library.h"
+#include "upload.h"
+#include "pipeline.h"
+#include "perf.h"
+#include "latency.h"
+#include "frame_trace.h"
+#include "heap_track.h"
+#include "stall.h"
+#include "drivers/motor_driver.h"
 
 // ==================== GLOBAL VARIABLES ====================
-PatternMode currentMode = MODE_STOP;
-int globalIntensity = 128;         // Default 50% intensity
-int waveSpeed = 100;               // Wave delay in milliseconds
-int currentWavePosition = 0;
-unsigned long lastWaveUpdate = 0;
+// One generator per mixer layer; layer 0 is the base pattern driven by
+// MODE:, INTENSITY: and SPEED:, layers 2+ are overlays set with LAYER:
+PatternLayer patternLayers[MAX_LAYERS];
+PatternLayer& baseLayer = patternLayers[0];
 
-// Motor intensity array for individual control
-int motorIntensities[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+bool frameDirty = true;            // Re-run the pipeline on the next tick
 
 // ==================== FUNCTION DECLARATIONS ====================
-void handleBluetoothInput();
-void handleSerialInput();
+void handleInput();
+bool isQueryCommand(String command);
 void processCommand(String command);
 void setMode(String mode);
 void setIntensity(int value);
 void setWaveSpeed(int value);
+void setOscillatorCommand(String args);
+void setSequenceCommand(String args);
+void setPatternExpression(String source);
+void playLibraryCommand(String args);
+void uploadCommand(String args);
+void serviceUploadLink();
+void setLayer(String args);
+bool playerModeTaken(PatternMode mode, int layer);
+int playerLayer(PatternMode mode);
+void sendLayer(int layer);
+int splitFields(String args, String fields[], int maxFields);
+void setCalibration(String args);
+void sendCalibration(int motor);
+void setShaping(String args);
+void setPowerLimitCommand(int value);
+void sendPipelineStats();
+void sendPerf();
+void resetPerfCommand();
+void heapCommand(String args);
+void stallCommand(String args);
+void sendLatency();
+void sendPong(String token);
+void traceCommand(String args);
+void runBenchmark(bool json);
 void sendStatus();
 void stopAllMotors();
+void updateShaping();
 void executePattern();
-void executeConstantPattern();
-void executeWavePattern();
 
 // ==================== SETUP ====================
 void setup() {
+  startHeapTracking();
+  
   // Initialize Serial Monitor
   Serial.begin(115200);
   Serial.println("================================");
@@ -64,69 +87,139 @@ void setup() {
   Serial.println("================================");
   
   // Initialize Bluetooth
-  if (!SerialBT.begin("SmartSheet_ESP32")) {
+  if (!Transport::begin("SmartSheet_ESP32")) {
     Serial.println("ERROR: Bluetooth initialization failed!");
     while (1); // Halt if Bluetooth fails
   }
   Serial.println("Bluetooth initialized: SmartSheet_ESP32");
   Serial.println("Waiting for connection...");
   
-  // Initialize PWM channels for each motor
-  for (int i = 0; i < NUM_MOTORS; i++) {
-    ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
-    ledcAttachPin(MOTOR_PINS[i], i);
-    ledcWrite(i, 0); // Start with motors off
-    Serial.printf("Motor %d initialized on GPIO %d (PWM Channel %d)\n", 
-                  i + 1, MOTOR_PINS[i], i);
+  // Load per-motor calibration and build duty tables
+  initCalibration();
+  initShaping();
+  initPipeline();
+  initOscillators();
+  initCycleCache();
+  if (mountLibrary()) {
+    Serial.printf("Pattern library: %d patterns\n", getLibraryCount());
+  }
+  else {
+    Serial.println("Pattern library: not found");
   }
+  for (int l = 0; l < MAX_LAYERS; l++) {
+    initPatternLayer(patternLayers[l], l);
+  }
+  
+  // Initialize the motor output backend
+  Serial.printf("Motor driver: %s\n", MotorDriver::name());
+  MotorDriver::begin();
   
   Serial.println("================================");
   Serial.println("System Ready!");
-  Serial.println("Commands: MODE:STOP, MODE:CONSTANT, MODE:WAVE");
+  Serial.println("Commands: MODE:STOP, MODE:CONSTANT, MODE:WAVE, MODE:OSC, MODE:SEQ, MODE:EXPR");
   Serial.println("          INTENSITY:0-255, SPEED:50-500, STATUS");
+  Serial.println("          OSC:PULSE|BREATHE|BEAT|TRAVEL, OSC:TABLE:<512 HEX>");
+  Serial.printf("          OSC:<1-%d|ALL>:<SINE|TRI|SQUARE|SAW|CUSTOM>:<mHz>:<DEG>:<AMP>:<OFFSET>\n", NUM_MOTORS);
+  Serial.println("          SEQ:KEY:<MS>:<HEXMASK|ALL>:<VALUE>:<RAMP_MS>:<LINEAR|IN|OUT|INOUT|STEP>");
+  Serial.println("          SEQ:JUMP:<MS>:<INDEX>:<REPEATS>, SEQ:END:<MS>");
+  Serial.println("          SEQ:CLEAR, SEQ:PLAY, SEQ:STOP, SEQ:STATUS");
+  Serial.println("          PLAY:<ID>, PLAY:LIST");
+  Serial.println("          UPLOAD:BEGIN:<SIZE>:<CRC32 HEX>, UPLOAD:ABORT  (SPP only)");
+  Serial.println("          PATTERN:<expr of t, i, n, I>  e.g. PATTERN:(sin(t*2 + i*0.8)+1)/2*I");
+  Serial.printf("          LAYER:<2-%d>:<MODE>:<INTENSITY>:<SPEED>:<ADD|MAX|MUL|FADE>:<OPACITY>\n", MAX_LAYERS);
+  Serial.printf("          LAYER:<2-%d>:OFF, LAYER:<2-%d>\n", MAX_LAYERS, MAX_LAYERS);
+  Serial.printf("          CAL:<1-%d>:<THRESHOLD>:<GAIN%%>:<GAMMAx100>\n", NUM_MOTORS);
+  Serial.printf("          CAL:<1-%d>, CAL:RESET\n", NUM_MOTORS);
+  Serial.printf("          SHAPE:ON, SHAPE:OFF, SHAPE:<1-%d>:<RISE_MS>:<FALL_MS>\n", NUM_MOTORS);
+  Serial.println("          LIMIT:10-100, PIPELINE, BENCH, BENCH:JSON");
+  Serial.println("          PERF, PERF:RESET, LATENCY, PING:<TOKEN>");
+  Serial.println("          TRACE, TRACE:CLEAR, TRACE:DUMP, HEAP, HEAP:RESET");
+  Serial.println("          STALL, STALL:LOG, STALL:CLEAR, STALL:<STAGE>:<US>");
   Serial.println("================================\n");
+  
+  resetPerf(Clock::millis());
+  resetLatency();
+  initStall();
+  
+  // From here on the loop should not touch the heap (see heap_track.h)
+  armHeapGuard();
 }
 
 // ==================== MAIN LOOP ====================
 void loop() {
-  // Handle Bluetooth commands
-  handleBluetoothInput();
+  stallLoopBegin();
   
-  // Handle Serial Monitor commands (for debugging)
-  handleSerialInput();
+  // Handle Bluetooth and Serial Monitor commands
+  handleInput();
   
   // Execute current pattern
+  uint32_t tickStart = Clock::cycles();
   executePattern();
+  perfRecord(perf.tick, (Clock::cycles() - tickStart) / Clock::cyclesPerMicro());
+  latencyTick(Clock::micros());
+  stallStage(STALL_PATTERN);
+  
+  // Settle motors whose kick/brake transient has finished
+  updateShaping();
+  stallStage(STALL_SHAPING);
+  
+  perfLoop(Transport::txQueued());
+  checkHeapGuard();
+  stallLoopEnd();
 }
 
-// ==================== BLUETOOTH INPUT HANDLER ====================
-void handleBluetoothInput() {
-  if (SerialBT.available()) {
-    String command = SerialBT.readStringUntil('\n');
-    command.trim();
-    if (command.length() > 0) {
-      Serial.print("BT Received: ");
-      Serial.println(command);
-      processCommand(command);
-    }
+// ==================== INPUT HANDLER ====================
+void handleInput() {
+  HeapSite site("input");
+  
+  // A bulk upload owns the link until it finishes or pauses
+  if (isUploadActive()) {
+    serviceUploadLink();
+    stallStage(STALL_UPLOAD);
+    return;
+  }
+  
+  String command;
+  bool received = Transport::poll(command);
+  stallStage(STALL_RX, Transport::source());
+  if (received) {
+    unsigned long lineUs = Clock::micros();
+    uint32_t commits = outputCommits;
+    uint32_t start = Clock::cycles();
+    processCommand(command);
+    perfRecord(perf.command, (Clock::cycles() - start) / Clock::cyclesPerMicro());
+    latencyCommand(Transport::arrivalMicros(), lineUs, Clock::micros(), 
+                   !isQueryCommand(command), commits);
+    stallStage(STALL_CMD);
   }
 }
 
-// ==================== SERIAL INPUT HANDLER ====================
-void handleSerialInput() {
-  if (Serial.available()) {
-    String command = Serial.readStringUntil('\n');
-    command.trim();
-    if (command.length() > 0) {
-      Serial.print("Serial Received: ");
-      Serial.println(command);
-      processCommand(command);
-    }
+// Commands that only report state never reach the motors, so latency
+// tracing does not wait for an output commit after them
+bool isQueryCommand(String command) {
+  command.toUpperCase();
+  if (command == "STATUS" || command == "PIPELINE" || command == "LATENCY" || 
+      command == "SEQ:STATUS" || command == "PLAY:LIST" || 
+      command.startsWith("PERF") || command.startsWith("BENCH") || 
+      command.startsWith("PING:") || command.startsWith("UPLOAD:") || 
+      command.startsWith("TRACE") || command.startsWith("HEAP") || 
+      command.startsWith("STALL")) {
+    return true;
   }
+  // LAYER:<n> and CAL:<n> read back one layer's or motor's settings
+  if (command.startsWith("LAYER:") || (command.startsWith("CAL:") && command != "CAL:RESET")) {
+    return command.indexOf(':', command.indexOf(':') + 1) < 0;
+  }
+  return false;
 }
 
 // ==================== COMMAND PROCESSOR ====================
 void processCommand(String command) {
+  HeapSite site("command");
+  
+  // PATTERN: expressions are case-sensitive (i is the motor index, I the
+  // intensity), so keep the original text for them
+  String original = command;
   command.toUpperCase();
   
   if (command.startsWith("MODE:")) {
@@ -141,13 +234,69 @@ void processCommand(String command) {
     int value = command.substring(6).toInt();
     setWaveSpeed(value);
   }
+  else if (command.startsWith("OSC:")) {
+    setOscillatorCommand(command.substring(4));
+  }
+  else if (command.startsWith("SEQ:")) {
+    setSequenceCommand(command.substring(4));
+  }
+  else if (command.startsWith("PATTERN:")) {
+    setPatternExpression(original.substring(8));
+  }
+  else if (command.startsWith("PLAY:")) {
+    playLibraryCommand(command.substring(5));
+  }
+  else if (command.startsWith("UPLOAD:")) {
+    uploadCommand(command.substring(7));
+  }
+  else if (command.startsWith("LAYER:")) {
+    setLayer(command.substring(6));
+  }
+  else if (command.startsWith("CAL:")) {
+    setCalibration(command.substring(4));
+  }
+  else if (command.startsWith("SHAPE:")) {
+    setShaping(command.substring(6));
+  }
   else if (command == "STATUS") {
     sendStatus();
   }
+  else if (command.startsWith("LIMIT:")) {
+    setPowerLimitCommand(command.substring(6).toInt());
+  }
+  else if (command == "PIPELINE") {
+    sendPipelineStats();
+  }
+  else if (command == "PERF") {
+    sendPerf();
+  }
+  else if (command == "PERF:RESET") {
+    resetPerfCommand();
+  }
+  else if (command == "LATENCY") {
+    sendLatency();
+  }
+  else if (command.startsWith("PING:")) {
+    sendPong(original.substring(5));
+  }
+  else if (command == "TRACE" || command.startsWith("TRACE:")) {
+    traceCommand(command.substring(5));
+  }
+  else if (command == "HEAP" || command.startsWith("HEAP:")) {
+    heapCommand(command.substring(4));
+  }
+  else if (command == "STALL" || command.startsWith("STALL:")) {
+    stallCommand(command.substring(5));
+  }
+  else if (command == "BENCH") {
+    runBenchmark(false);
+  }
+  else if (command == "BENCH:JSON") {
+    runBenchmark(true);
+  }
   else {
     String errorMsg = "ERROR: Unknown command - " + command;
-    Serial.println(errorMsg);
-    SerialBT.println(errorMsg);
+    Transport::send(errorMsg);
   }
 }
 
@@ -156,25 +305,43 @@ void setMode(String mode) {
   String response;
   
   if (mode == "STOP") {
-    currentMode = MODE_STOP;
+    baseLayer.mode = MODE_STOP;
     stopAllMotors();
     response = "OK:MODE:STOP";
   }
   else if (mode == "CONSTANT") {
-    currentMode = MODE_CONSTANT;
+    baseLayer.mode = MODE_CONSTANT;
     response = "OK:MODE:CONSTANT";
   }
   else if (mode == "WAVE") {
-    currentMode = MODE_WAVE;
-    currentWavePosition = 0;
+    baseLayer.mode = MODE_WAVE;
+    baseLayer.wavePosition = 0;
+    preparePatternCache(baseLayer);
     response = "OK:MODE:WAVE";
   }
+  else if (mode == "OSC") {
+    baseLayer.mode = MODE_OSC;
+    response = "OK:MODE:OSC";
+  }
+  else if (mode == "SEQ") {
+    if (playerModeTaken(MODE_SEQ, 0)) {
+      response = "ERROR:PLAYER_BUSY";
+    }
+    else {
+      baseLayer.mode = MODE_SEQ;
+      startSequence(Clock::millis());
+      response = "OK:MODE:SEQ";
+    }
+  }
+  else if (mode == "EXPR") {
+    baseLayer.mode = MODE_EXPR;
+    response = "OK:MODE:EXPR";
+  }
   else {
     response = "ERROR:INVALID_MODE";
   }
   
-  Serial.println(response);
-  SerialBT.println(response);
+  Transport::send(response);
 }
 
 // ==================== INTENSITY SETTER ====================
@@ -182,15 +349,15 @@ void setIntensity(int value) {
   String response;
   
   if (value >= 0 && value <= 255) {
-    globalIntensity = value;
+    baseLayer.intensity = value;
+    preparePatternCache(baseLayer);
     response = "OK:INTENSITY:" + String(value);
   }
   else {
     response = "ERROR:INTENSITY_OUT_OF_RANGE";
   }
   
-  Serial.println(response);
-  SerialBT.println(response);
+  Transport::send(response);
 }
 
 // ==================== WAVE SPEED SETTER ====================
@@ -198,99 +365,869 @@ void setWaveSpeed(int value) {
   String response;
   
   if (value >= 50 && value <= 500) {
-    waveSpeed = value;
+    baseLayer.speed = value;
+    preparePatternCache(baseLayer);
     response = "OK:SPEED:" + String(value);
   }
   else {
     response = "ERROR:SPEED_OUT_OF_RANGE";
   }
   
-  Serial.println(response);
-  SerialBT.println(response);
+  Transport::send(response);
 }
 
-// ==================== STATUS SENDER ====================
-void sendStatus() {
-  String modeStr;
-  switch (currentMode) {
-    case MODE_STOP:     modeStr = "STOP"; break;
-    case MODE_CONSTANT: modeStr = "CONSTANT"; break;
-    case MODE_WAVE:     modeStr = "WAVE"; break;
-  }
+// ==================== OSCILLATOR SETTER ====================
+// OSC:<preset>                                      configure all motors, MODE:OSC
+// OSC:<motor|ALL>:<wave>:<mHz>:<deg>:<amp>:<offset>  configure one or all motors
+// OSC:TABLE:<512 hex digits>                        load the CUSTOM waveform
+void setOscillatorCommand(String args) {
+  String response;
+  String fields[6];
+  int count = splitFields(args, fields, 6);
+  OscillatorPreset preset;
   
-  String status = "STATUS:MODE:" + modeStr + 
-                  ",INTENSITY:" + String(globalIntensity) + 
-                  ",SPEED:" + String(waveSpeed);
+  if (count == 1 && parseOscillatorPreset(fields[0].c_str(), preset)) {
+    applyOscillatorPreset(preset, baseLayer.intensity, baseLayer.speed);
+    baseLayer.mode = MODE_OSC;
+    response = "OK:OSC:" + fields[0];
+  }
+  else if (count == 2 && fields[0] == "TABLE") {
+    uint8_t table[OSC_TABLE_SIZE];
+    bool valid = fields[1].length() == OSC_TABLE_SIZE * 2;
+    for (int i = 0; valid && i < OSC_TABLE_SIZE; i++) {
+      char hex[3] = {fields[1][2 * i], fields[1][2 * i + 1], 0};
+      char* end;
+      table[i] = strtol(hex, &end, 16);
+      valid = end == hex + 2;
+    }
+    if (valid) {
+      setCustomWaveform(table);
+      response = "OK:OSC:TABLE";
+    }
+    else {
+      response = "ERROR:OSC_TABLE_FORMAT";
+    }
+  }
+  else if (count == 6) {
+    Waveform waveform;
+    bool all = fields[0] == "ALL";
+    int motor = fields[0].toInt() - 1;
+    bool ok = parseWaveform(fields[1].c_str(), waveform) && (all || motor >= 0);
+    
+    for (int i = all ? 0 : motor; ok && i < (all ? NUM_MOTORS : motor + 1); i++) {
+      ok = setOscillator(i, waveform, fields[2].toInt(), fields[3].toInt(),
+                         fields[4].toInt(), fields[5].toInt());
+    }
+    response = ok ? "OK:OSC:" + args : String("ERROR:OSC_OUT_OF_RANGE");
+  }
+  else {
+    response = "ERROR:OSC_FORMAT";
+  }
   
-  Serial.println(status);
-  SerialBT.println(status);
+  Transport::send(response);
 }
 
-// ==================== STOP ALL MOTORS ====================
-void stopAllMotors() {
-  for (int i = 0; i < NUM_MOTORS; i++) {
-    motorIntensities[i] = 0;
-    ledcWrite(i, 0);
+// ==================== SEQUENCE SETTER ====================
+// SEQ:KEY:<ms>:<mask>:<value>:<ramp_ms>:<easing>  append a ramp keyframe
+// SEQ:JUMP:<ms>:<index>:<repeats>                 append a loop marker (0 = forever)
+// SEQ:END:<ms>                                    append an end marker
+// SEQ:CLEAR / SEQ:PLAY / SEQ:STOP / SEQ:STATUS
+void setSequenceCommand(String args) {
+  String response;
+  String fields[6];
+  int count = splitFields(args, fields, 6);
+  Keyframe key = {};
+  key.timeMs = fields[1].toInt();
+  
+  if (count == 1 && fields[0] == "CLEAR") {
+    clearSequence();
+    response = "OK:SEQ:CLEAR";
   }
-  Serial.println("All motors stopped");
+  else if (count == 1 && fields[0] == "PLAY") {
+    // Restarts the sequencer for the overlay that owns it, else the base
+    if (playerLayer(MODE_SEQ) < 0) {
+      baseLayer.mode = MODE_SEQ;
+    }
+    response = startSequence(Clock::millis()) ? "OK:SEQ:PLAY" : "ERROR:SEQ_EMPTY";
+  }
+  else if (count == 1 && fields[0] == "STOP") {
+    stopSequence();
+    response = "OK:SEQ:STOP";
+  }
+  else if (count == 1 && fields[0] == "STATUS") {
+    SequencerStatus status = getSequencerStatus(Clock::millis());
+    response = "SEQ:" + String(status.playing ? "PLAYING" : "STOPPED") + 
+               ",KEYS:" + String(status.keyCount) + 
+               ",CURSOR:" + String(status.cursor) + 
+               ",TIME:" + String(status.trackTime);
+  }
+  else if (count == 6 && fields[0] == "KEY") {
+    Easing easing;
+    uint64_t mask = fields[2] == "ALL" ? ~0ULL : strtoull(fields[2].c_str(), NULL, 16);
+    int value = fields[3].toInt();
+    key.op = SEQ_OP_KEY;
+    key.maskLow = (uint32_t)mask;
+    key.maskHigh = (uint32_t)(mask >> 32);
+    key.value = constrain(value, 0, 255);
+    key.arg = fields[4].toInt();
+    
+    if (!parseEasing(fields[5].c_str(), easing) || value != key.value) {
+      response = "ERROR:SEQ_FORMAT";
+    }
+    else {
+      key.easing = easing;
+      response = addKeyframe(key) ? "OK:SEQ:" + args : String("ERROR:SEQ_REJECTED");
+    }
+  }
+  else if (count == 4 && fields[0] == "JUMP") {
+    long target = fields[2].toInt();
+    long repeats = fields[3].toInt();
+    
+    if (target < 0 || target > SEQ_JUMP_FIELD_MAX || repeats < 0 || repeats > SEQ_JUMP_FIELD_MAX) {
+      response = "ERROR:SEQ_FORMAT";
+    }
+    else {
+      key.op = SEQ_OP_JUMP;
+      key.arg = jumpArg(target, repeats);
+      response = addKeyframe(key) ? "OK:SEQ:" + args : String("ERROR:SEQ_REJECTED");
+    }
+  }
+  else if (count == 2 && fields[0] == "END") {
+    key.op = SEQ_OP_END;
+    response = addKeyframe(key) ? "OK:SEQ:" + args : String("ERROR:SEQ_REJECTED");
+  }
+  else {
+    response = "ERROR:SEQ_FORMAT";
+  }
+  
+  Transport::send(response);
 }
 
-// ==================== PATTERN EXECUTOR ====================
-void executePattern() {
-  switch (currentMode) {
-    case MODE_STOP:
-      // Motors already stopped, do nothing
-      break;
+// ==================== LAYER SETTER ====================
+// LAYER:<n>:<mode>:<intensity>:<speed>:<blend>:<opacity>  configure an overlay
+// LAYER:<n>:OFF                                           remove an overlay
+// LAYER:<n>                                               report an overlay
+void setLayer(String args) {
+  String response;
+  String fields[6];
+  int count = splitFields(args, fields, 6);
+  int layer = fields[0].toInt() - 1;
+  
+  if (layer < 1 || layer >= MAX_LAYERS) {
+    response = "ERROR:LAYER_INVALID";
+  }
+  else if (count == 1) {
+    sendLayer(layer);
+    return;
+  }
+  else if (count == 2 && fields[1] == "OFF") {
+    mixLayers[layer].active = false;
+    patternLayers[layer].mode = MODE_STOP;
+    frameDirty = true;
+    response = "OK:LAYER:" + String(layer + 1) + ":OFF";
+  }
+  else if (count != 6) {
+    response = "ERROR:LAYER_FORMAT";
+  }
+  else {
+    PatternMode mode;
+    BlendMode blend;
+    int intensity = fields[2].toInt();
+    int speed = fields[3].toInt();
+    int opacity = fields[5].toInt();
+    
+    if (!parsePatternMode(fields[1].c_str(), mode) || !parseBlendMode(fields[4].c_str(), blend)) {
+      response = "ERROR:LAYER_FORMAT";
+    }
+    else if (intensity < 0 || intensity > 255 || speed < 50 || speed > 500 ||
+             opacity < 0 || opacity > 255) {
+      response = "ERROR:LAYER_OUT_OF_RANGE";
+    }
+    else if (playerModeTaken(mode, layer)) {
+      response = "ERROR:PLAYER_BUSY";
+    }
+    else {
+      PatternLayer& pattern = patternLayers[layer];
+      pattern.mode = mode;
+      pattern.intensity = intensity;
+      pattern.speed = speed;
+      pattern.wavePosition = 0;
+      preparePatternCache(pattern);
       
-    case MODE_CONSTANT:
-      executeConstantPattern();
-      break;
+      MixLayer& mix = mixLayers[layer];
+      memset(&mix.frame, 0, sizeof(mix.frame));
+      mix.blend = blend;
+      mix.opacity = opacity;
+      mix.active = true;
+      frameDirty = true;
       
-    case MODE_WAVE:
-      executeWavePattern();
+      // PLAY streams start with PLAY:<id>, which has the record to play
+      if (mode == MODE_SEQ) {
+        startSequence(Clock::millis());
+      }
+      response = "OK:LAYER:" + args;
+    }
+  }
+  
+  Transport::send(response);
+}
+
+// SEQ and PLAY each drive a single shared player (the sequencer and the
+// library stream), so only one layer at a time may use each of them
+bool playerModeTaken(PatternMode mode, int layer) {
+  if (mode != MODE_SEQ && mode != MODE_PLAY) {
+    return false;
+  }
+  for (int l = 0; l < MAX_LAYERS; l++) {
+    if (l != layer && (l == 0 || mixLayers[l].active) && patternLayers[l].mode == mode) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The layer that owns a shared player, or -1 while it is free
+int playerLayer(PatternMode mode) {
+  for (int l = 0; l < MAX_LAYERS; l++) {
+    if ((l == 0 || mixLayers[l].active) && patternLayers[l].mode == mode) {
+      return l;
+    }
+  }
+  return -1;
+}
+
+// ==================== LAYER SENDER ====================
+void sendLayer(int layer) {
+  const PatternLayer& pattern = patternLayers[layer];
+  const MixLayer& mix = mixLayers[layer];
+  String response = "LAYER:" + String(layer + 1);
+  
+  if (mix.active) {
+    response += ":" + String(patternModeName(pattern.mode)) + 
+                ":" + String(pattern.intensity) + 
+                ":" + String(pattern.speed) + 
+                ":" + String(blendModeName(mix.blend)) + 
+                ":" + String(mix.opacity);
+  }
+  else {
+    response += ":OFF";
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== FIELD SPLITTER ====================
+// Splits "A:B:C" into fields, returns how many were found (at most maxFields)
+int splitFields(String args, String fields[], int maxFields) {
+  int count = 0;
+  int start = 0;
+  while (count < maxFields) {
+    int sep = args.indexOf(':', start);
+    if (sep < 0) {
+      fields[count++] = args.substring(start);
       break;
+    }
+    fields[count++] = args.substring(start, sep);
+    start = sep + 1;
+  }
+  return count;
+}
+
+// ==================== CALIBRATION SETTER ====================
+// CAL:<motor>:<threshold>:<gain>:<gamma>  set and persist one motor
+// CAL:<motor>                             report one motor
+// CAL:RESET                               restore defaults for all motors
+void setCalibration(String args) {
+  String response;
+  
+  if (args == "RESET") {
+    resetCalibration();
+    frameDirty = true;
+    response = "OK:CAL:RESET";
+    Transport::send(response);
+    return;
+  }
+  
+  int sep = args.indexOf(':');
+  int motor = (sep < 0 ? args : args.substring(0, sep)).toInt() - 1;
+  if (motor < 0 || motor >= NUM_MOTORS) {
+    response = "ERROR:CAL_INVALID_MOTOR";
+    Transport::send(response);
+    return;
+  }
+  
+  if (sep < 0) {
+    sendCalibration(motor);
+    return;
+  }
+  
+  String fields = args.substring(sep + 1);
+  int sep1 = fields.indexOf(':');
+  int sep2 = sep1 < 0 ? -1 : fields.indexOf(':', sep1 + 1);
+  if (sep2 < 0) {
+    response = "ERROR:CAL_FORMAT";
+    Transport::send(response);
+    return;
+  }
+  
+  int threshold = fields.substring(0, sep1).toInt();
+  int gain = fields.substring(sep1 + 1, sep2).toInt();
+  int gamma = fields.substring(sep2 + 1).toInt();
+  
+  MotorCalibration cal;
+  cal.startThreshold = constrain(threshold, 0, 255);
+  cal.gainPercent = constrain(gain, 0, 255);
+  cal.gammaX100 = constrain(gamma, 0, 1000);
+  
+  if (threshold != cal.startThreshold || gain != cal.gainPercent ||
+      gamma != cal.gammaX100 || !setMotorCalibration(motor, cal)) {
+    response = "ERROR:CAL_OUT_OF_RANGE";
+    Transport::send(response);
+    return;
+  }
+  
+  // Re-run the pipeline so the new curve takes effect even in CONSTANT mode
+  frameDirty = true;
+  
+  response = "OK:CAL:" + String(motor + 1) + ":" + String(threshold) +
+             ":" + String(gain) + ":" + String(gamma);
+  Transport::send(response);
+}
+
+// ==================== CALIBRATION SENDER ====================
+void sendCalibration(int motor) {
+  const MotorCalibration& cal = getMotorCalibration(motor);
+  String response = "CAL:" + String(motor + 1) + 
+                    ":" + String(cal.startThreshold) + 
+                    ":" + String(cal.gainPercent) + 
+                    ":" + String(cal.gammaX100);
+  
+  Transport::send(response);
+}
+
+// ==================== SHAPING SETTER ====================
+// SHAPE:ON / SHAPE:OFF                    enable or bypass transient shaping
+// SHAPE:<motor>:<rise_ms>:<fall_ms>       set one motor's time constants
+// SHAPE:<motor>                           report one motor's model
+void setShaping(String args) {
+  String response;
+  
+  if (args == "ON" || args == "OFF") {
+    setShapingEnabled(args == "ON");
+    response = "OK:SHAPE:" + args;
+    Transport::send(response);
+    return;
+  }
+  
+  int sep = args.indexOf(':');
+  int motor = (sep < 0 ? args : args.substring(0, sep)).toInt() - 1;
+  if (motor < 0 || motor >= NUM_MOTORS) {
+    response = "ERROR:SHAPE_INVALID_MOTOR";
+  }
+  else if (sep < 0) {
+    const MotorModel& model = getMotorModel(motor);
+    response = "SHAPE:" + String(motor + 1) + ":" + String(model.riseMs) +
+               ":" + String(model.fallMs);
+  }
+  else {
+    int sep1 = args.indexOf(':', sep + 1);
+    int rise = sep1 < 0 ? -1 : args.substring(sep + 1, sep1).toInt();
+    int fall = sep1 < 0 ? -1 : args.substring(sep1 + 1).toInt();
+    
+    MotorModel model;
+    model.riseMs = constrain(rise, 0, SHAPE_TAU_MAX + 1);
+    model.fallMs = constrain(fall, 0, SHAPE_TAU_MAX + 1);
+    
+    if (sep1 < 0) {
+      response = "ERROR:SHAPE_FORMAT";
+    }
+    else if (!setMotorModel(motor, model)) {
+      response = "ERROR:SHAPE_OUT_OF_RANGE";
+    }
+    else {
+      response = "OK:SHAPE:" + String(motor + 1) + ":" + String(rise) +
+                 ":" + String(fall);
+    }
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== STATUS SENDER ====================
+void sendStatus() {
+  String modeStr = patternModeName(baseLayer.mode);
+  
+  String status = "STATUS:MODE:" + modeStr + 
+                  ",INTENSITY:" + String(baseLayer.intensity) + 
+                  ",SPEED:" + String(baseLayer.speed);
+  
+  Transport::send(status);
+}
+
+// ==================== POWER LIMIT SETTER ====================
+void setPowerLimitCommand(int value) {
+  String response;
+  
+  if (setPowerLimit(value)) {
+    frameDirty = true;
+    response = "OK:LIMIT:" + String(value);
+  }
+  else {
+    response = "ERROR:LIMIT_OUT_OF_RANGE";
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== PIPELINE STATS SENDER ====================
+void sendPipelineStats() {
+  const PipelineStats& stats = getPipelineStats();
+  String response = "PIPELINE:CYCLES:" + String(stats.lastCycles) + 
+                    ",MAX:" + String(stats.maxCycles) + 
+                    ",BUDGET:" + String(PIPELINE_CYCLE_BUDGET) + 
+                    ",RUNS:" + String(stats.runs) + 
+                    ",OVERRUNS:" + String(stats.overruns);
+  
+  Transport::send(response);
+}
+
+// ==================== PERFORMANCE COUNTERS ====================
+void sendPerf() {
+  Transport::send(formatPerf(Clock::millis()));
+}
+
+void resetPerfCommand() {
+  resetPerf(Clock::millis());
+  resetLatency();
+  Transport::send("OK:PERF:RESET");
+}
+
+// ==================== LATENCY TRACING ====================
+void sendLatency() {
+  Transport::send(formatLatency());
+}
+
+// PING:<token>  echo the token with the device's arrival and reply times
+// (Clock::micros()), so the app can work out RTT and clock offset
+void sendPong(String token) {
+  String response;
+  token.trim();
+  
+  if (token.length() == 0) {
+    response = "ERROR:PING_TOKEN";
+  }
+  else {
+    response = "PONG:" + token + 
+               ":" + String(Transport::arrivalMicros()) + 
+               ":" + String(Clock::micros());
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== FRAME TRACE ====================
+// TRACE          ring status
+// TRACE:CLEAR    drop everything recorded so far
+// TRACE:DUMP     header line, then the raw blocks (see frame_trace.h)
+void traceCommand(String args) {
+  String response;
+  
+  if (args == "") {
+    FrameTraceStatus status = getFrameTraceStatus();
+    response = "TRACE:FRAMES:" + String(status.frames) + 
+               ",BLOCKS:" + String(status.blocks) + "/" + String(TRACE_BLOCKS) + 
+               ",BYTES:" + String(status.bytes) + 
+               ",SPAN_MS:" + String(status.spanUs / 1000);
   }
+  else if (args == ":CLEAR") {
+    clearFrameTrace();
+    response = "OK:TRACE:CLEAR";
+  }
+  else if (args == ":DUMP") {
+    // TRACE:DUMP:<bytes>:<crc32 hex>:<motors>:<block size>, then the bytes
+    FrameTraceStatus status = getFrameTraceStatus();
+    response = "TRACE:DUMP:" + String(status.bytes) + 
+               ":" + String(frameTraceCrc(), HEX) + 
+               ":" + String(NUM_MOTORS) + 
+               ":" + String(TRACE_BLOCK_SIZE);
+    Transport::send(response);
+    dumpFrameTrace(Transport::link());
+    return;
+  }
+  else {
+    response = "ERROR:TRACE_COMMAND";
+  }
+  
+  Transport::send(response);
 }
 
-// ==================== CONSTANT PATTERN ====================
-void executeConstantPattern() {
-  for (int i = 0; i < NUM_MOTORS; i++) {
-    if (motorIntensities[i] != globalIntensity) {
-      motorIntensities[i] = globalIntensity;
-      ledcWrite(i, globalIntensity);
+// ==================== HEAP TRACKING ====================
+// HEAP          allocation counters, then one HEAP:SITE line per call site
+// HEAP:RESET    clear counters and sites (peak restarts from live bytes)
+void heapCommand(String args) {
+#if defined(HEAP_TRACKING)
+  static HeapSiteStats sites[HEAP_SITES];
+  
+  if (args == "") {
+    // Snapshot first: building the replies allocates too
+    HeapStats stats = getHeapStats();
+    int count = getHeapSites(sites, HEAP_SITES);
+  
+    Transport::send("HEAP:ALLOCS:" + String(stats.allocs) +
+                    ",FREES:" + String(stats.frees) +
+                    ",LIVE:" + String(stats.live) +
+                    ",PEAK:" + String(stats.peak) +
+                    ",AFTER_BOOT:" + String(stats.afterBoot) +
+                    ",SITES:" + String(count) + "/" + String(stats.dropped));
+    for (int s = 0; s < count; s++) {
+      Transport::send("HEAP:SITE:" + String(sites[s].tag) +
+                      ":" + String((uint32_t)(uintptr_t)sites[s].caller, HEX) +
+                      ":" + String(sites[s].count) +
+                      ":" + String(sites[s].bytes));
     }
   }
+  else if (args == ":RESET") {
+    resetHeapStats();
+    Transport::send("OK:HEAP:RESET");
+  }
+  else {
+    Transport::send("ERROR:HEAP_COMMAND");
+  }
+#else
+  (void)args;
+  Transport::send("ERROR:HEAP_TRACKING_DISABLED");
+#endif
 }
 
-// ==================== WAVE PATTERN ====================
-void executeWavePattern() {
-  unsigned long currentTime = millis();
+// ==================== STALL DETECTOR ====================
+// STALL                  per-stage overruns, worst case and limit
+// STALL:LOG              logged overrun events, oldest first
+// STALL:CLEAR            drop the counts and the log
+// STALL:<STAGE>:<US>     set a stage's limit, 0 to stop checking it
+void stallCommand(String args) {
+  String response;
   
-  if (currentTime - lastWaveUpdate >= (unsigned long)waveSpeed) {
-    lastWaveUpdate = currentTime;
+  if (args == "") {
+    response = formatStall();
+  }
+  else if (args == ":LOG") {
+    StallEvent events[STALL_LOG_SIZE];
+    int count = getStallEvents(events, STALL_LOG_SIZE);
+    for (int k = 0; k < count; k++) {
+      String stage = stallStageName(events[k].stage);
+      if (events[k].link) {
+        stage += "_" + String(events[k].link);
+      }
+      Transport::send("STALL:EVENT:" + String(events[k].ms) + 
+                      ":" + stage + 
+                      ":" + String(events[k].us) + 
+                      ":" + String(events[k].limitUs));
+    }
+    response = "OK:STALL:LOG:" + String(count);
+  }
+  else if (args == ":CLEAR") {
+    clearStallLog();
+    response = "OK:STALL:CLEAR";
+  }
+  else {
+    int split = args.indexOf(':', 1);
+    String stage = split > 0 ? args.substring(1, split) : "";
+    String value = split > 0 ? args.substring(split + 1) : "";
+    long us = value.toInt();
     
-    // Calculate intensity for each motor based on wave position
-    for (int i = 0; i < NUM_MOTORS; i++) {
-      // Create a sine wave effect
-      float phase = (float)(i - currentWavePosition) / NUM_MOTORS * 2 * PI;
-      float waveValue = (sin(phase) + 1) / 2; // Normalize to 0-1
-      int intensity = (int)(waveValue * globalIntensity);
+    if (value.length() == 0 || (us == 0 && value != "0") || us < 0 || 
+        !setStallLimit(stage, us)) {
+      response = "ERROR:STALL_COMMAND";
+    }
+    else {
+      response = "OK:STALL:" + stage + ":" + String(us);
+    }
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== PATTERN EXPRESSION ====================
+// PATTERN:<expr>  compile an expression and switch the base layer to it
+void setPatternExpression(String source) {
+  String response;
+  source.trim();
+  
+  int errorPos = 0;
+  ExprError error = compileExpression(source.c_str(), activeExpression, errorPos);
+  if (error == EXPR_OK) {
+    expressionStartTime = Clock::millis();
+    baseLayer.mode = MODE_EXPR;
+    baseLayer.lastUpdate = 0;
+    response = "OK:PATTERN:" + String(activeExpression.length) + 
+               ":" + String(activeExpression.maxStack);
+  }
+  else if (error == EXPR_ERR_SYNTAX) {
+    response = "ERROR:PATTERN_SYNTAX:" + String(errorPos);
+  }
+  else if (error == EXPR_ERR_STACK) {
+    response = "ERROR:PATTERN_STACK";
+  }
+  else {
+    response = "ERROR:PATTERN_TOO_LONG";
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== FLASH LIBRARY ====================
+// PLAY:<id>   play a library record on the base layer
+// PLAY:LIST   list the library index
+void playLibraryCommand(String args) {
+  String response;
+  
+  if (!isLibraryMounted()) {
+    response = "ERROR:LIBRARY_MISSING";
+  }
+  else if (args == "LIST") {
+    for (int k = 0; k < getLibraryCount(); k++) {
+      const LibraryEntry* entry = getLibraryEntry(k);
+      String line = "LIBRARY:" + String(entry->id) + 
+                    ":" + String(libraryKindName(entry->kind)) + 
+                    ":" + String(entry->frameCount) + 
+                    ":" + String(entry->frameMs);
+      Transport::send(line);
+    }
+    response = "OK:LIBRARY:" + String(getLibraryCount());
+  }
+  else {
+    int id = args.toInt();
+    const LibraryEntry* entry = (id > 0 || args == "0") ? findLibraryEntry(id) : NULL;
+    unsigned long now = Clock::millis();
+    
+    if (entry == NULL) {
+      response = "ERROR:PLAY_NOT_FOUND";
+    }
+    else {
+      // Plays on the layer that owns the player, else takes over the base
+      PatternMode mode = entry->kind == LIB_TRACK ? MODE_SEQ : MODE_PLAY;
+      int owner = playerLayer(mode);
+      PatternLayer& layer = patternLayers[owner < 0 ? 0 : owner];
       
-      motorIntensities[i] = intensity;
-      ledcWrite(i, intensity);
+      if (entry->kind == LIB_TRACK) {
+        // Tracks play in place from mapped flash through the sequencer
+        if (layer.mode == MODE_PLAY) {
+          stopLibraryPlayback();
+        }
+        playTrack((const Keyframe*)libraryRecord(*entry), entry->frameCount, now);
+      }
+      else {
+        startLibraryPlayback(*entry, now);
+      }
+      layer.mode = mode;
+      response = "OK:PLAY:" + String(id);
     }
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== LIBRARY UPLOAD ====================
+// UPLOAD:BEGIN:<size>:<crc32 hex>  start or resume a binary upload over SPP
+// UPLOAD:ABORT                     drop a paused upload
+void uploadCommand(String args) {
+  String response;
+  String fields[3];
+  int count = splitFields(args, fields, 3);
+  
+  if (count == 3 && fields[0] == "BEGIN") {
+    uint32_t size = fields[1].toInt();
+    uint32_t crc = strtoul(fields[2].c_str(), NULL, 16);
+    uint32_t resumeOffset = 0;
     
-    // Move wave position
-    currentWavePosition = (currentWavePosition + 1) % NUM_MOTORS;
+    UploadError error = beginUpload(size, crc, Clock::millis(), resumeOffset);
+    if (error == UPLOAD_OK) {
+      response = "OK:UPLOAD:" + String(resumeOffset) + 
+                 ":" + String(UPLOAD_CHUNK_SIZE) + 
+                 ":" + String(UPLOAD_WINDOW);
+    }
+    else if (error == UPLOAD_ERR_NO_PARTITION) {
+      response = "ERROR:LIBRARY_MISSING";
+    }
+    else if (error == UPLOAD_ERR_TOO_LARGE) {
+      response = "ERROR:UPLOAD_TOO_LARGE";
+    }
+    else {
+      response = "ERROR:UPLOAD_FLASH";
+    }
+  }
+  else if (count == 1 && fields[0] == "ABORT") {
+    abortUpload();
+    response = "OK:UPLOAD:ABORT";
+  }
+  else {
+    response = "ERROR:INVALID_UPLOAD";
+  }
+  
+  Transport::send(response);
+}
+
+void serviceUploadLink() {
+  UploadEvent event = serviceUpload(Transport::link(), Transport::connected(), Clock::millis());
+  if (event == UPLOAD_RUNNING) {
+    return;
+  }
+  
+  const UploadResult& result = getUploadResult();
+  String response;
+  if (event == UPLOAD_DONE) {
+    uint32_t kbps = result.elapsedMs ? 
+                    (uint32_t)((uint64_t)result.sessionBytes * 1000 / 1024 / result.elapsedMs) : 0;
+    bool mounted = mountLibrary();
+    response = "OK:UPLOAD:DONE:" + String(result.size) + 
+               ":" + String(result.elapsedMs) + 
+               ":" + String(kbps) + 
+               ":" + String(mounted ? getLibraryCount() : 0);
+  }
+  else if (event == UPLOAD_PAUSED) {
+    response = "UPLOAD:PAUSED:" + String(result.offset);
+  }
+  else if (result.error == UPLOAD_ERR_CRC) {
+    response = "ERROR:UPLOAD_CRC";
+  }
+  else {
+    response = "ERROR:UPLOAD_FLASH";
+  }
+  
+  Transport::send(response);
+}
+
+// ==================== BENCHMARK ====================
+// Read-only commands, so the parser benchmark leaves state untouched
+static const char* const BENCH_COMMANDS[] = {
+  "STATUS", "PIPELINE", "LAYER:2", "CAL:1", "SEQ:STATUS", "BOGUS"
+};
+const int BENCH_COMMAND_COUNT = sizeof(BENCH_COMMANDS) / sizeof(BENCH_COMMANDS[0]);
+
+void collectBenchmarks(BenchmarkResults& results) {
+  results.driver = MotorDriver::name();
+  results.commit = benchmarkCommit(committedFrame.values, BENCH_COMMIT_FRAMES);
+  
+  uint8_t values[16];
+  for (int i = 0; i < 16; i++) {
+    values[i] = i * 17;
+  }
+  results.bitplanePacked = benchmarkBitplanes(values, BENCH_BITPLANE_FRAMES, false);
+  results.bitplaneScalar = benchmarkBitplanes(values, BENCH_BITPLANE_FRAMES, true);
+  
+  // Interpreted wave against the hand-written renderer it reproduces
+  results.expression = benchmarkExpression(BENCH_WAVE_EXPRESSION, baseLayer.intensity, 
+                                           BENCH_PATTERN_FRAMES);
+  results.waveRender = benchmarkWave(baseLayer, BENCH_PATTERN_FRAMES);
+  
+  PatternLayer probe = baseLayer;
+  probe.mode = MODE_CONSTANT;
+  results.tickConstant = benchmarkPatternTick(probe, BENCH_TICK_ROUNDS);
+  probe.mode = MODE_WAVE;
+  results.tickWave = benchmarkPatternTick(probe, BENCH_TICK_ROUNDS);
+  results.tickOscillator = benchmarkOscillatorRender(BENCH_PATTERN_FRAMES);
+  
+  Transport::muted = true;
+  results.command = benchmarkCommands(processCommand, BENCH_COMMANDS, 
+                                      BENCH_COMMAND_COUNT, BENCH_COMMAND_ROUNDS);
+  results.statusReply = benchmarkReply(sendStatus, BENCH_REPLY_ROUNDS);
+  Transport::muted = false;
+  
+  results.library = isLibraryMounted();
+  if (results.library) {
+    results.libraryLookup = benchmarkLibraryLookup(BENCH_LOOKUP_ROUNDS);
+    results.libraryStream = benchmarkLibraryStream();
+    results.frameDecode = benchmarkFrameDecode();
+  }
+}
+
+// BENCH prints one line per group, BENCH:JSON the whole run as one object
+void runBenchmark(bool json) {
+  BenchmarkResults results;
+  collectBenchmarks(results);
+  
+  if (json) {
+    Transport::send("BENCH:JSON:" + formatBenchmarkJson(results));
+    return;
+  }
+  
+  String response = "BENCH:COMMIT:" + String(results.driver) + 
+                    ":" + String(results.commit);
+  Transport::send(response);
+  
+  response = "BENCH:BITPLANE:" + String(results.bitplanePacked) + 
+             ":" + String(results.bitplaneScalar);
+  Transport::send(response);
+  
+  response = "BENCH:EXPR:" + String(results.expression) + 
+             ":" + String(results.waveRender);
+  Transport::send(response);
+  
+  response = "BENCH:TICK:" + String(results.tickConstant) + 
+             ":" + String(results.tickWave) + 
+             ":" + String(results.tickOscillator);
+  Transport::send(response);
+  
+  response = "BENCH:PARSER:" + String(results.command) + 
+             ":" + String(commandsPerSecond(results.command)) + 
+             ":" + String(results.statusReply);
+  Transport::send(response);
+  
+  if (results.library) {
+    response = "BENCH:LIBRARY:" + String(results.libraryLookup) + 
+               ":" + String(results.libraryStream);
+    Transport::send(response);
     
-    // Debug output
-    Serial.print("Wave Position: ");
-    Serial.print(currentWavePosition);
-    Serial.print(" | Intensities: ");
-    for (int i = 0; i < NUM_MOTORS; i++) {
-      Serial.print(motorIntensities[i]);
-      Serial.print(" ");
-    }
-    Serial.println();
+    response = "BENCH:LZ:" + String(results.frameDecode);
+    Transport::send(response);
+  }
+}
+
+// ==================== STOP ALL MOTORS ====================
+// Stops every layer, not just the base pattern
+void stopAllMotors() {
+  for (int l = 0; l < MAX_LAYERS; l++) {
+    patternLayers[l].mode = MODE_STOP;
+    mixLayers[l].active = false;
+    memset(&mixLayers[l].frame, 0, sizeof(mixLayers[l].frame));
+  }
+  runPipeline(mixLayers[0].frame, Clock::millis());
+  Serial.println("All motors stopped");
+}
+
+// ==================== TRANSIENT SHAPING ====================
+void updateShaping() {
+  HeapSite site("shaping");
+  unsigned long now = Clock::millis();
+  Motors::forEach([now](int i) {
+    int duty = shapingTick(i, now);
+    if (duty >= 0) {
+      MotorDriver::write(i, duty);
+    }
+  });
+  MotorDriver::commit();
+}
+
+// ==================== PATTERN EXECUTOR ====================
+// Each layer's generator fills its mixer frame and reports whether it
+// changed; the pipeline mixes and outputs them from there
+void executePattern() {
+  HeapSite site("pattern");
+  unsigned long now = Clock::millis();
+  bool changed = false;
+  
+  for (int l = 0; l < MAX_LAYERS; l++) {
+    if (l == 0 || mixLayers[l].active) {
+      changed |= generatePattern(patternLayers[l], mixLayers[l].frame, now);
+    }
+  }
+  
+  if (changed) {
+    perfFrame(Clock::micros());
+  }
+  
+  if (changed || frameDirty) {
+    frameDirty = false;
+    runPipeline(mixLayers[0].frame, now);
   }
 }
@@ -0,0 +1,26 @@
+/*
+ * Smart Sheet - Layer mixer
+ */
+
+#include "mixer.h"
+#include <string.h>
+
+// ==================== GLOBAL VARIABLES ====================
+MixLayer mixLayers[MAX_LAYERS];
+
+// ==================== BLEND MODE NAMES ====================
+static const char* BLEND_NAMES[] = {"ADD", "MAX", "MUL", "FADE"};
+
+bool parseBlendMode(const char* name, BlendMode& mode) {
+  for (int i = 0; i < (int)(sizeof(BLEND_NAMES) / sizeof(BLEND_NAMES[0])); i++) {
+    if (strcmp(name, BLEND_NAMES[i]) == 0) {
+      mode = (BlendMode)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* blendModeName(BlendMode mode) {
+  return BLEND_NAMES[mode];
+}
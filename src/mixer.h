@@ -0,0 +1,82 @@
+/*
+ * Smart Sheet - Layer mixer
+ * Up to MAX_LAYERS pattern frames combined into one. Layer 0 is the base
+ * pattern; each further active layer is blended on top in order with its
+ * own blend mode and opacity:
+ *
+ *   ADD       base + layer * opacity, saturating
+ *   MAX       max(base, layer * opacity)
+ *   MULTIPLY  base faded towards base * layer by opacity
+ *   CROSSFADE base faded towards layer by opacity
+ *
+ * All blends run four motors per 32-bit word with SWAR arithmetic.
+ */
+
+#ifndef SMARTSHEET_MIXER_H
+#define SMARTSHEET_MIXER_H
+
+#include "frame.h"
+#include "swar.h"
+
+const int MAX_LAYERS = 4;
+
+enum BlendMode {
+  BLEND_ADD,
+  BLEND_MAX,
+  BLEND_MULTIPLY,
+  BLEND_CROSSFADE
+};
+
+struct MixLayer {
+  bool active;
+  BlendMode blend;
+  uint8_t opacity;
+  MotorFrame frame;
+};
+
+extern MixLayer mixLayers[MAX_LAYERS];
+
+// ==================== BLENDING ====================
+static inline void blendFrame(MotorFrame& dst, const MotorFrame& src, BlendMode mode, uint8_t opacity) {
+  uint32_t s = swarOpacity(opacity);
+  switch (mode) {
+    case BLEND_ADD:
+      for (int w = 0; w < FRAME_WORDS; w++) {
+        dst.words[w] = swarAddSat(dst.words[w], swarScale(src.words[w], s));
+      }
+      break;
+
+    case BLEND_MAX:
+      for (int w = 0; w < FRAME_WORDS; w++) {
+        dst.words[w] = swarMax(dst.words[w], swarScale(src.words[w], s));
+      }
+      break;
+
+    case BLEND_MULTIPLY:
+      for (int w = 0; w < FRAME_WORDS; w++) {
+        dst.words[w] = swarLerp(dst.words[w], swarMultiply(dst.words[w], src.words[w]), s);
+      }
+      break;
+
+    case BLEND_CROSSFADE:
+      for (int w = 0; w < FRAME_WORDS; w++) {
+        dst.words[w] = swarLerp(dst.words[w], src.words[w], s);
+      }
+      break;
+  }
+}
+
+// Blends every active overlay layer onto a copy of the base layer
+static inline void mixOverlays(MotorFrame& frame) {
+  for (int l = 1; l < MAX_LAYERS; l++) {
+    if (mixLayers[l].active) {
+      blendFrame(frame, mixLayers[l].frame, mixLayers[l].blend, mixLayers[l].opacity);
+    }
+  }
+}
+
+// ==================== FUNCTION DECLARATIONS ====================
+bool parseBlendMode(const char* name, BlendMode& mode);
+const char* blendModeName(BlendMode mode);
+
+#endif
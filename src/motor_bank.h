@@ -0,0 +1,64 @@
+/*
+ * Smart Sheet - Motor bank
+ * Compile-time description of the motor outputs, parameterised on the
+ * GPIO pin list. Everything sized by the motor count (frames, tables,
+ * wave math) derives from MotorBank::size, and per-motor loops in the hot
+ * path are unrolled through forEach().
+ *
+ * For GPIO backends the parameters are GPIO numbers; for expander backends
+ * they are expander channel numbers (see ChannelBank).
+ *
+ * LEDC channels are interleaved across the two speed groups
+ * (motor 0 -> ch 0, motor 1 -> ch 8, motor 2 -> ch 1, ...) so both groups'
+ * timers share the load as the bank grows to 16 motors.
+ */
+
+#ifndef SMARTSHEET_MOTOR_BANK_H
+#define SMARTSHEET_MOTOR_BANK_H
+
+#include <stdint.h>
+#include <utility>
+
+const int LEDC_CHANNELS_PER_GROUP = 8;
+const int LEDC_CHANNELS = 2 * LEDC_CHANNELS_PER_GROUP;
+const int MOTOR_BANK_MAX = 64;
+
+template <int... Pins>
+struct MotorBank {
+  static constexpr int size = sizeof...(Pins);
+  static constexpr int pins[size] = {Pins...};
+
+  static_assert(size >= 1, "Motor bank needs at least one pin");
+  static_assert(size <= MOTOR_BANK_MAX, "Motor bank is limited to 64 motors");
+
+  // Even motors on the high-speed group, odd motors on the low-speed group
+  static constexpr int ledcChannel(int motor) {
+    return (motor % 2) * LEDC_CHANNELS_PER_GROUP + motor / 2;
+  }
+
+  // Calls f(i) for every motor index with the loop fully unrolled
+  template <typename F>
+  static inline void forEach(F&& f) {
+    forEachIndex(f, std::make_integer_sequence<int, size>());
+  }
+
+private:
+  template <typename F, int... Is>
+  static inline __attribute__((always_inline)) void forEachIndex(F& f, std::integer_sequence<int, Is...>) {
+    (f(Is), ...);
+  }
+};
+
+// Bank of Count outputs addressed by channel number 0..Count-1
+template <typename Seq>
+struct SequentialBank;
+
+template <int... Channels>
+struct SequentialBank<std::integer_sequence<int, Channels...>> {
+  typedef MotorBank<Channels...> type;
+};
+
+template <int Count>
+using ChannelBank = typename SequentialBank<std::make_integer_sequence<int, Count>>::type;
+
+#endif
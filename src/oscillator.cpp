@@ -0,0 +1,127 @@
+/*
+ * Smart Sheet - DDS oscillator bank
+ * Waveform tables, channel setup and presets
+ */
+
+#include "oscillator.h"
+
+// ==================== GLOBAL VARIABLES ====================
+uint8_t waveformTables[WAVEFORM_COUNT][OSC_TABLE_SIZE];
+Oscillator oscillators[NUM_MOTORS];
+
+static uint32_t tickCount = 0;
+static unsigned long lastTick = 0;
+
+static const char* WAVEFORM_NAMES[] = {"SINE", "TRI", "SQUARE", "SAW", "CUSTOM"};
+static const char* PRESET_NAMES[] = {"PULSE", "BREATHE", "BEAT", "TRAVEL"};
+
+// ==================== HELPERS ====================
+// Phase step per tick for a frequency in mHz: f * 2^32 / tick rate
+static uint32_t phaseIncrement(uint32_t frequencyMilliHz) {
+  return (uint32_t)(((uint64_t)frequencyMilliHz << 32) / (1000000ULL / OSC_TICK_MS));
+}
+
+static uint32_t phaseFromDegrees(int degrees) {
+  return (uint32_t)(((uint64_t)(degrees % 360) << 32) / 360);
+}
+
+// ==================== SETUP ====================
+// Tables are built once at boot, so float math is fine here
+void initOscillators() {
+  for (int i = 0; i < OSC_TABLE_SIZE; i++) {
+    waveformTables[WAVE_SINE][i] = (uint8_t)((sin(i * 2 * PI / OSC_TABLE_SIZE) + 1) * 127.5f);
+    waveformTables[WAVE_TRIANGLE][i] = i < 128 ? i * 2 : (255 - i) * 2 + 1;
+    waveformTables[WAVE_SQUARE][i] = i < 128 ? 255 : 0;
+    waveformTables[WAVE_SAW][i] = i;
+    waveformTables[WAVE_CUSTOM][i] = waveformTables[WAVE_SINE][i];
+  }
+
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    setOscillator(i, WAVE_SINE, 1000, 0, 255, 0);
+  }
+}
+
+bool setOscillator(int motor, Waveform waveform, uint32_t frequencyMilliHz,
+                   int phaseDegrees, int amplitude, int offset) {
+  if (motor < 0 || motor >= NUM_MOTORS || waveform >= WAVEFORM_COUNT ||
+      frequencyMilliHz > OSC_MAX_FREQUENCY_MHZ || phaseDegrees < 0 ||
+      amplitude < 0 || amplitude > 255 || offset < 0 || offset > 255) {
+    return false;
+  }
+
+  Oscillator& osc = oscillators[motor];
+  osc.phase = phaseFromDegrees(phaseDegrees);
+  osc.increment = phaseIncrement(frequencyMilliHz);
+  osc.waveform = waveform;
+  osc.amplitude = amplitude;
+  osc.offset = offset;
+  return true;
+}
+
+void setCustomWaveform(const uint8_t* table) {
+  memcpy(waveformTables[WAVE_CUSTOM], table, OSC_TABLE_SIZE);
+}
+
+// ==================== PRESETS ====================
+// intensity scales every preset; speed (ms per step, as for MODE:WAVE)
+// sets the travelling wave's rate
+void applyOscillatorPreset(OscillatorPreset preset, int intensity, int speed) {
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    switch (preset) {
+      case PRESET_PULSE:
+        setOscillator(i, WAVE_SQUARE, 1000, 0, intensity, 0);
+        break;
+
+      case PRESET_BREATHE:
+        setOscillator(i, WAVE_SINE, 200, 270, intensity, 0);
+        break;
+
+      case PRESET_BEAT:
+        setOscillator(i, WAVE_SINE, i % 2 ? 2250 : 2000, 0, intensity, 0);
+        break;
+
+      case PRESET_TRAVEL:
+        // One motor per step: a full cycle crosses the sheet in N steps
+        setOscillator(i, WAVE_SINE, 1000000UL / ((uint32_t)NUM_MOTORS * speed),
+                      360 - i * 360 / NUM_MOTORS, intensity, 0);
+        break;
+    }
+  }
+}
+
+// ==================== NAME PARSING ====================
+bool parseWaveform(const char* name, Waveform& waveform) {
+  for (int i = 0; i < WAVEFORM_COUNT; i++) {
+    if (strcmp(name, WAVEFORM_NAMES[i]) == 0) {
+      waveform = (Waveform)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parseOscillatorPreset(const char* name, OscillatorPreset& preset) {
+  for (int i = 0; i < (int)(sizeof(PRESET_NAMES) / sizeof(PRESET_NAMES[0])); i++) {
+    if (strcmp(name, PRESET_NAMES[i]) == 0) {
+      preset = (OscillatorPreset)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ==================== TICK ====================
+uint32_t advanceOscillators(unsigned long now) {
+  uint32_t ticks = (now - lastTick) / OSC_TICK_MS;
+  if (ticks == 0) {
+    return tickCount;
+  }
+
+  // Catch up on missed ticks in one step so timing never drifts
+  lastTick += ticks * OSC_TICK_MS;
+  tickCount += ticks;
+  Motors::forEach([ticks](int i) {
+    oscillators[i].phase += oscillators[i].increment * ticks;
+  });
+  return tickCount;
+}
@@ -0,0 +1,73 @@
+/*
+ * Smart Sheet - DDS oscillator bank
+ * One direct digital synthesis oscillator per motor. Each tick adds the
+ * channel's increment to a 32-bit phase accumulator; the top 8 bits index
+ * a shared 256-entry waveform table, scaled by amplitude and lifted by
+ * offset. The tick path is integer-only.
+ *
+ * Pulse, breathe, beat and travelling-wave effects are all presets of
+ * this one kernel (see applyOscillatorPreset).
+ */
+
+#ifndef SMARTSHEET_OSCILLATOR_H
+#define SMARTSHEET_OSCILLATOR_H
+
+#include <Arduino.h>
+#include "frame.h"
+
+// ==================== OSCILLATOR CONFIGURATION ====================
+const int OSC_TICK_MS = 2;                   // 500 Hz fixed tick
+const int OSC_TABLE_SIZE = 256;
+const uint32_t OSC_MAX_FREQUENCY_MHZ = 50000; // 50 Hz, well past ERM response
+
+enum Waveform {
+  WAVE_SINE,
+  WAVE_TRIANGLE,
+  WAVE_SQUARE,
+  WAVE_SAW,
+  WAVE_CUSTOM,
+  WAVEFORM_COUNT
+};
+
+enum OscillatorPreset {
+  PRESET_PULSE,                      // All motors on/off together
+  PRESET_BREATHE,                    // Slow in-phase sine swell
+  PRESET_BEAT,                       // Neighbours detuned, interference beats
+  PRESET_TRAVEL                      // Sine with phase spread along the sheet
+};
+
+struct Oscillator {
+  uint32_t phase;
+  uint32_t increment;                // Phase step per tick
+  uint8_t waveform;
+  uint8_t amplitude;
+  uint8_t offset;
+};
+
+extern uint8_t waveformTables[WAVEFORM_COUNT][OSC_TABLE_SIZE];
+extern Oscillator oscillators[NUM_MOTORS];
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initOscillators();
+bool setOscillator(int motor, Waveform waveform, uint32_t frequencyMilliHz,
+                   int phaseDegrees, int amplitude, int offset);
+void applyOscillatorPreset(OscillatorPreset preset, int intensity, int speed);
+void setCustomWaveform(const uint8_t* table);
+bool parseWaveform(const char* name, Waveform& waveform);
+bool parseOscillatorPreset(const char* name, OscillatorPreset& preset);
+
+// Advances every phase by the ticks elapsed since the last call and
+// returns the running tick count
+uint32_t advanceOscillators(unsigned long now);
+
+// ==================== TICK KERNEL ====================
+static inline void renderOscillators(MotorFrame& frame) {
+  Motors::forEach([&frame](int i) {
+    const Oscillator& osc = oscillators[i];
+    uint32_t sample = waveformTables[osc.waveform][osc.phase >> 24];
+    uint32_t value = osc.offset + ((sample * (osc.amplitude + 1)) >> 8);
+    frame.values[i] = value > 255 ? 255 : value;
+  });
+}
+
+#endif
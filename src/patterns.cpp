@@ -0,0 +1,164 @@
+/*
+ * Smart Sheet - Pattern generators
+ */
+
+#include "patterns.h"
+#include "oscillator.h"
+#include "cycle_cache.h"
+#include "sequencer.h"
+#include "expr.h"
+#include "library.h"
+
+// ==================== MODE NAMES ====================
+static const char* MODE_NAMES[] = {"STOP", "CONSTANT", "WAVE", "OSC", "SEQ", "EXPR", "PLAY"};
+
+bool parsePatternMode(const char* name, PatternMode& mode) {
+  for (int i = 0; i < (int)(sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0])); i++) {
+    if (strcmp(name, MODE_NAMES[i]) == 0) {
+      mode = (PatternMode)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* patternModeName(PatternMode mode) {
+  return MODE_NAMES[mode];
+}
+
+void initPatternLayer(PatternLayer& layer, int id) {
+  layer.id = id;
+  layer.mode = MODE_STOP;
+  layer.intensity = 128;             // Default 50% intensity
+  layer.speed = 100;
+  layer.wavePosition = 0;
+  layer.lastUpdate = 0;
+}
+
+// ==================== CONSTANT PATTERN ====================
+static bool executeConstantPattern(PatternLayer& layer, MotorFrame& frame) {
+  bool changed = false;
+  Motors::forEach([&](int i) {
+    if (frame.values[i] != layer.intensity) {
+      frame.values[i] = layer.intensity;
+      changed = true;
+    }
+  });
+  return changed;
+}
+
+// ==================== WAVE PATTERN ====================
+// The wave repeats every NUM_MOTORS steps and only intensity changes its
+// frames (speed only changes step timing), so it is served from the cycle
+// cache keyed on intensity
+static uint32_t waveCacheKey(const PatternLayer& layer) {
+  return layer.intensity;
+}
+
+void renderWaveStep(const PatternLayer& layer, int position, MotorFrame& frame) {
+  // Calculate intensity for each motor based on wave position
+  Motors::forEach([&](int i) {
+    // Create a sine wave effect
+    float phase = (float)(i - position) / NUM_MOTORS * 2 * PI;
+    float waveValue = (sin(phase) + 1) / 2; // Normalize to 0-1
+    int intensity = (int)(waveValue * layer.intensity);
+    
+    frame.values[i] = intensity;
+  });
+}
+
+static bool executeWavePattern(PatternLayer& layer, MotorFrame& frame, unsigned long currentTime) {
+  if (currentTime - layer.lastUpdate >= (unsigned long)layer.speed) {
+    layer.lastUpdate = currentTime;
+    
+    uint32_t key = waveCacheKey(layer);
+    if (!cachedCycleFrame(layer.id, key, layer.wavePosition, frame)) {
+      renderWaveStep(layer, layer.wavePosition, frame);
+      requestCycleCompile(layer.id, key, layer, renderWaveStep, NUM_MOTORS);
+    }
+    
+    // Move wave position
+    layer.wavePosition = (layer.wavePosition + 1) % NUM_MOTORS;
+    
+#if defined(WAVE_DEBUG)
+    // Step trace on the USB console (tools/traffic.py --console times it);
+    // off by default so a step stays a table copy and a commit
+    Serial.print("Wave Position: ");
+    Serial.print(layer.wavePosition);
+    Serial.print(" | Intensities: ");
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      Serial.print(frame.values[i]);
+      Serial.print(" ");
+    }
+    Serial.println();
+#endif
+    return true;
+  }
+  return false;
+}
+
+// ==================== CACHE PREPARATION ====================
+// Called when a layer's parameters change, so the new table is usually
+// compiled before the next step needs it
+void preparePatternCache(const PatternLayer& layer) {
+  if (layer.mode == MODE_WAVE) {
+    requestCycleCompile(layer.id, waveCacheKey(layer), layer, renderWaveStep, NUM_MOTORS);
+  }
+}
+
+// ==================== OSCILLATOR PATTERN ====================
+// The bank is shared, so each layer renders once per bank tick
+static bool executeOscillatorPattern(PatternLayer& layer, MotorFrame& frame, unsigned long now) {
+  uint32_t tick = advanceOscillators(now);
+  if (tick == layer.lastUpdate) {
+    return false;
+  }
+  layer.lastUpdate = tick;
+  renderOscillators(frame);
+  return true;
+}
+
+// ==================== EXPRESSION PATTERN ====================
+// Evaluates the compiled PATTERN: program for every motor each tick
+static bool executeExpressionPattern(PatternLayer& layer, MotorFrame& frame, unsigned long now) {
+  if (now - layer.lastUpdate < (unsigned long)EXPR_TICK_MS) {
+    return false;
+  }
+  layer.lastUpdate = now;
+
+  ExprInputs inputs;
+  uint32_t elapsed = (now - expressionStartTime) % (EXPR_T_PERIOD_S * 1000);
+  inputs.t = (int32_t)(((uint64_t)elapsed << 16) / 1000);
+  inputs.n = NUM_MOTORS << 16;
+  inputs.intensity = layer.intensity << 16;
+  renderExpression(activeExpression, inputs, frame);
+  return true;
+}
+
+// ==================== PATTERN EXECUTOR ====================
+bool generatePattern(PatternLayer& layer, MotorFrame& frame, unsigned long now) {
+  switch (layer.mode) {
+    case MODE_STOP:
+      // Motors already stopped, do nothing
+      return false;
+      
+    case MODE_CONSTANT:
+      return executeConstantPattern(layer, frame);
+      
+    case MODE_WAVE:
+      return executeWavePattern(layer, frame, now);
+      
+    case MODE_OSC:
+      return executeOscillatorPattern(layer, frame, now);
+      
+    case MODE_SEQ:
+      return sequencerTick(now, frame);
+      
+    case MODE_EXPR:
+      return executeExpressionPattern(layer, frame, now);
+      
+    case MODE_PLAY:
+      return libraryTick(now, frame);
+  }
+  return false;
+}
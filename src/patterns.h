@@ -0,0 +1,42 @@
+/*
+ * Smart Sheet - Pattern generators
+ * Each mixer layer runs its own generator with its own mode, intensity,
+ * speed and wave state. Generators write logical intensities into the
+ * layer's frame and report whether it changed.
+ */
+
+#ifndef SMARTSHEET_PATTERNS_H
+#define SMARTSHEET_PATTERNS_H
+
+#include <Arduino.h>
+#include "frame.h"
+
+// ==================== PATTERN MODES ====================
+enum PatternMode {
+  MODE_STOP,
+  MODE_CONSTANT,
+  MODE_WAVE,
+  MODE_OSC,                          // Renders the shared DDS oscillator bank
+  MODE_SEQ,                          // Plays the keyframe sequencer
+  MODE_EXPR,                         // Evaluates the PATTERN: expression
+  MODE_PLAY                          // Streams a FRAMES record from the flash library
+};
+
+struct PatternLayer {
+  uint8_t id;                        // Mixer layer index
+  PatternMode mode;
+  int intensity;                     // 0-255
+  int speed;                         // Wave delay in milliseconds
+  int wavePosition;
+  unsigned long lastUpdate;          // Wave: last step time, OSC: last tick rendered
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initPatternLayer(PatternLayer& layer, int id);
+void preparePatternCache(const PatternLayer& layer);
+void renderWaveStep(const PatternLayer& layer, int position, MotorFrame& frame);
+bool generatePattern(PatternLayer& layer, MotorFrame& frame, unsigned long now);
+bool parsePatternMode(const char* name, PatternMode& mode);
+const char* patternModeName(PatternMode mode);
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Smart Sheet - Runtime performance counters
+ */
+
+#include "perf.h"
+#include "hal/system.h"
+
+// ==================== GLOBAL VARIABLES ====================
+PerfCounters perf;
+
+// Task run-time counters at the last reset, so CPU shares cover the same
+// interval as every other counter
+static TaskStat taskBase[PERF_MAX_TASKS];
+static int taskBaseCount = 0;
+static uint32_t runTimeBase = 0;
+
+// ==================== RESET ====================
+void resetPerf(unsigned long now) {
+  memset(&perf, 0, sizeof(perf));
+  perf.since = now;
+  taskBaseCount = System::taskStats(taskBase, PERF_MAX_TASKS, runTimeBase);
+}
+
+// ==================== FRAME JITTER ====================
+void perfFrame(unsigned long nowUs) {
+  uint32_t interval = nowUs - perf.lastFrameUs;
+  perf.lastFrameUs = nowUs;
+  if (perf.frames < 2) {
+    perf.frames++;
+    perf.lastIntervalUs = interval;
+    return;
+  }
+  uint32_t change = interval > perf.lastIntervalUs ? interval - perf.lastIntervalUs
+                                                   : perf.lastIntervalUs - interval;
+  perf.lastIntervalUs = interval;
+  perfRecord(perf.jitter, change);
+}
+
+// ==================== FORMATTING ====================
+String formatPerfHistogram(const PerfHistogram& histogram) {
+  int last = PERF_BUCKETS - 1;
+  while (last > 0 && histogram.counts[last] == 0) {
+    last--;
+  }
+  String text = String(histogram.counts[0]);
+  for (int b = 1; b <= last; b++) {
+    text += ".";
+    text += String(histogram.counts[b]);
+  }
+  return text;
+}
+
+static uint32_t average(const PerfHistogram& histogram) {
+  return histogram.samples ? histogram.sum / histogram.samples : 0;
+}
+
+static uint32_t baseRunTime(const void* id) {
+  for (int k = 0; k < taskBaseCount; k++) {
+    if (taskBase[k].id == id) {
+      return taskBase[k].runTime;
+    }
+  }
+  return 0;
+}
+
+static String formatTasks() {
+  static TaskStat tasks[PERF_MAX_TASKS];
+  uint32_t runTimeTotal;
+  int count = System::taskStats(tasks, PERF_MAX_TASKS, runTimeTotal);
+  uint32_t elapsed = runTimeTotal - runTimeBase;
+
+  String text;
+  for (int k = 0; k < count; k++) {
+    if (k > 0) {
+      text += ";";
+    }
+    text += String(tasks[k].name) + "/" + String(tasks[k].stackFree) + "/";
+    if (elapsed == 0) {
+      text += "-";
+    }
+    else {
+      uint32_t used = tasks[k].runTime - baseRunTime(tasks[k].id);
+      text += String((uint32_t)((uint64_t)used * 100 / elapsed));
+    }
+  }
+  return count ? text : String("-");
+}
+
+String formatPerf(unsigned long now) {
+  unsigned long elapsed = now - perf.since;
+  uint32_t loopRate = elapsed ? (uint64_t)perf.loops * 1000 / elapsed : 0;
+
+  return "PERF:LOOPS:" + String(loopRate) + 
+         ",TICK:" + String(average(perf.tick)) + "/" + String(perf.tick.max) + 
+         ",TICKH:" + formatPerfHistogram(perf.tick) + 
+         ",JITTER:" + String(perf.jitter.max) + 
+         ",JITTERH:" + formatPerfHistogram(perf.jitter) + 
+         ",CMD:" + String(perf.command.samples) + "/" + String(average(perf.command)) + 
+         "/" + String(perf.command.max) + 
+         ",TXQ:" + String(perf.txQueued) + "/" + String(perf.txQueuedMax) + 
+         ",HEAP:" + String(System::freeHeap()) + "/" + String(System::largestFreeBlock()) + 
+         "/" + String(System::minFreeHeap()) + 
+         ",TASKS:" + formatTasks();
+}
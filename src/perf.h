@@ -0,0 +1,76 @@
+/*
+ * Smart Sheet - Runtime performance counters
+ * Cheap counters updated from loop(), reported by PERF and cleared by
+ * PERF:RESET. Durations are recorded in microseconds into log2
+ * histograms: bucket 0 counts 0 us, bucket k counts [2^(k-1), 2^k) us and
+ * the last bucket collects everything longer.
+ *
+ * PERF replies on one line:
+ *
+ *   PERF:LOOPS:<per s>,TICK:<avg>/<max>,TICKH:<h>,JITTER:<max>,JITTERH:<h>,
+ *        CMD:<count>/<avg>/<max>,TXQ:<now>/<max>,HEAP:<free>/<largest>/<min>,
+ *        TASKS:<name>/<stack free>/<cpu %>;...
+ *
+ * <h> is the bucket counts joined with '.', trailing empty buckets
+ * dropped. TICK is executePattern(), CMD is processCommand() including its
+ * reply, and JITTER is how much the interval between successive changed
+ * frames moved. CPU shares are over the time since the last reset, or '-'
+ * where the scheduler keeps no run-time counters.
+ */
+
+#ifndef SMARTSHEET_PERF_H
+#define SMARTSHEET_PERF_H
+
+#include <Arduino.h>
+
+const int PERF_BUCKETS = 24;                 // Up to 2^23 us, about 8 s
+const int PERF_MAX_TASKS = 16;
+
+struct PerfHistogram {
+  uint32_t counts[PERF_BUCKETS];
+  uint32_t samples;
+  uint32_t max;
+  uint64_t sum;
+};
+
+struct PerfCounters {
+  unsigned long since;               // Clock::millis() at reset
+  uint32_t loops;
+  PerfHistogram tick;
+  PerfHistogram jitter;
+  PerfHistogram command;
+  unsigned long lastFrameUs;
+  uint32_t lastIntervalUs;
+  uint8_t frames;                    // Up to 2, until an interval pair exists
+  int txQueued;
+  int txQueuedMax;
+};
+
+extern PerfCounters perf;
+
+// ==================== RECORDING ====================
+static inline void perfRecord(PerfHistogram& histogram, uint32_t us) {
+  int bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+  histogram.counts[bucket < PERF_BUCKETS ? bucket : PERF_BUCKETS - 1]++;
+  histogram.samples++;
+  histogram.sum += us;
+  if (us > histogram.max) {
+    histogram.max = us;
+  }
+}
+
+static inline void perfLoop(int txQueued) {
+  perf.loops++;
+  perf.txQueued = txQueued;
+  if (txQueued > perf.txQueuedMax) {
+    perf.txQueuedMax = txQueued;
+  }
+}
+
+// ==================== FUNCTION DECLARATIONS ====================
+void resetPerf(unsigned long now);
+void perfFrame(unsigned long nowUs);
+String formatPerfHistogram(const PerfHistogram& histogram);
+String formatPerf(unsigned long now);
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Smart Sheet - Frame pipeline
+ * Output frame storage, stage state and per-run cycle accounting
+ */
+
+#include "pipeline.h"
+#include "hal/clock.h"
+
+// ==================== GLOBAL VARIABLES ====================
+uint32_t limitDutySum = (uint32_t)NUM_MOTORS * PWM_MAX_DUTY;
+MotorFrame committedFrame;
+uint32_t outputCommits = 0;
+
+static MotorFrame outputFrame;
+static PipelineStats stats;
+static int powerLimitPercent = LIMIT_MAX_PERCENT;
+
+// ==================== PUBLIC API ====================
+void initPipeline() {
+  memset(&outputFrame, 0, sizeof(outputFrame));
+  memset(&committedFrame, 0, sizeof(committedFrame));
+  memset(&stats, 0, sizeof(stats));
+}
+
+void runPipeline(const MotorFrame& source, unsigned long now) {
+  uint32_t start = Clock::cycles();
+
+  outputFrame = source;
+  OutputPipeline::run(outputFrame, now);
+
+  uint32_t cycles = Clock::cycles() - start;
+  stats.lastCycles = cycles;
+  if (cycles > stats.maxCycles) {
+    stats.maxCycles = cycles;
+  }
+  if (cycles > PIPELINE_CYCLE_BUDGET) {
+    stats.overruns++;
+  }
+  stats.runs++;
+}
+
+bool setPowerLimit(int percent) {
+  if (percent < LIMIT_MIN_PERCENT || percent > LIMIT_MAX_PERCENT) {
+    return false;
+  }
+  powerLimitPercent = percent;
+  limitDutySum = (uint32_t)NUM_MOTORS * PWM_MAX_DUTY * percent / 100;
+  return true;
+}
+
+int getPowerLimit() {
+  return powerLimitPercent;
+}
+
+const PipelineStats& getPipelineStats() {
+  return stats;
+}
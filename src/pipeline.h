@@ -0,0 +1,117 @@
+/*
+ * Smart Sheet - Frame pipeline
+ * Pattern generators only fill a frame of logical intensities. Everything
+ * between that frame and the motor outputs is a fixed chain of in-place
+ * stages over one preallocated output frame:
+ *
+ *   generator -> mix -> calibrate -> limit -> commit
+ *
+ * The chain is composed at compile time (FramePipeline<Stages...>), so
+ * each stage call is inlined and adding a stage does not touch any
+ * pattern. Every run is timed in CPU cycles against a per-tick budget.
+ */
+
+#ifndef SMARTSHEET_PIPELINE_H
+#define SMARTSHEET_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frame.h"
+#include "mixer.h"
+#include "calibration.h"
+#include "shaping.h"
+#include "frame_trace.h"
+#include "drivers/motor_driver.h"
+
+// ==================== PIPELINE BUDGET ====================
+const uint32_t PIPELINE_CYCLE_BUDGET = 24000;   // 100 us at 240 MHz
+const int LIMIT_MIN_PERCENT = 10;
+const int LIMIT_MAX_PERCENT = 100;
+
+struct PipelineStats {
+  uint32_t lastCycles;
+  uint32_t maxCycles;
+  uint32_t runs;
+  uint32_t overruns;                 // Runs that exceeded the cycle budget
+};
+
+// ==================== STAGE STATE ====================
+extern uint32_t limitDutySum;        // Total duty allowed across all motors
+extern MotorFrame committedFrame;    // Duties last handed to the shaper/driver
+extern uint32_t outputCommits;       // Runs that changed at least one duty
+
+// ==================== STAGES ====================
+// Blends active overlay layers onto the base layer (SWAR, see mixer.h)
+struct MixStage {
+  static inline void process(MotorFrame& frame, unsigned long now) {
+    (void)now;
+    mixOverlays(frame);
+  }
+};
+
+// Logical intensity -> PWM duty through each motor's calibration LUT
+struct CalibrateStage {
+  static inline void process(MotorFrame& frame, unsigned long now) {
+    (void)now;
+    Motors::forEach([&frame](int i) {
+      frame.values[i] = calibratedDuty(i, frame.values[i]);
+    });
+  }
+};
+
+// Scales the whole frame down when total duty exceeds the supply budget,
+// keeping the pattern's shape
+struct LimitStage {
+  static inline void process(MotorFrame& frame, unsigned long now) {
+    (void)now;
+    uint32_t sum = 0;
+    Motors::forEach([&](int i) {
+      sum += frame.values[i];
+    });
+    if (sum <= limitDutySum) {
+      return;
+    }
+    uint32_t scale = (limitDutySum << 16) / sum;   // Q16
+    Motors::forEach([&](int i) {
+      frame.values[i] = (frame.values[i] * scale) >> 16;
+    });
+  }
+};
+
+// Hands changed duties to the transient shaper and output driver, and
+// records the committed frame in the trace ring
+struct CommitStage {
+  static inline void process(MotorFrame& frame, unsigned long now) {
+    uint64_t changed = 0;
+    Motors::forEach([&](int i) {
+      if (frame.values[i] != committedFrame.values[i]) {
+        committedFrame.values[i] = frame.values[i];
+        MotorDriver::write(i, shapeDuty(i, frame.values[i], now));
+        changed |= 1ULL << i;
+      }
+    });
+    MotorDriver::commit();
+    if (changed) {
+      outputCommits++;
+      traceFrame(changed, committedFrame.values);
+    }
+  }
+};
+
+template <typename... Stages>
+struct FramePipeline {
+  static inline void run(MotorFrame& frame, unsigned long now) {
+    (Stages::process(frame, now), ...);
+  }
+};
+
+typedef FramePipeline<MixStage, CalibrateStage, LimitStage, CommitStage> OutputPipeline;
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initPipeline();
+void runPipeline(const MotorFrame& source, unsigned long now);
+bool setPowerLimit(int percent);
+int getPowerLimit();
+const PipelineStats& getPipelineStats();
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Smart Sheet - Keyframe sequencer
+ * Track storage, cursor playback and easing ramps
+ */
+
+#include "sequencer.h"
+
+// ==================== CHANNEL RAMPS ====================
+struct ChannelRamp {
+  uint8_t from;
+  uint8_t to;
+  uint8_t easing;
+  uint32_t start;                          // Absolute ms
+  uint32_t duration;
+  uint32_t rate;                           // 2^32 / duration, avoids a divide per tick
+};
+
+// ==================== GLOBAL VARIABLES ====================
+static Keyframe ramTrack[SEQ_MAX_KEYFRAMES];
+static int ramKeyCount = 0;
+
+static const Keyframe* track = ramTrack;
+static int trackLength = 0;
+static int cursor = 0;
+static bool playing = false;
+static uint32_t origin = 0;                // Absolute ms of track time 0
+static unsigned long lastTick = 0;
+static uint16_t jumpCounts[SEQ_MAX_KEYFRAMES];   // Wide enough for any JUMP repeat count
+
+static ChannelRamp ramps[NUM_MOTORS];
+static uint64_t activeRamps = 0;
+static uint8_t values[NUM_MOTORS];
+
+static const char* EASING_NAMES[] = {"LINEAR", "IN", "OUT", "INOUT", "STEP"};
+
+// ==================== EASING ====================
+// p and result are Q16 progress (0..65536)
+static inline uint32_t ease(uint8_t easing, uint32_t p) {
+  switch (easing) {
+    case EASE_IN:
+      return (p * p) >> 16;
+    case EASE_OUT: {
+      // q reaches 65536 at p = 0, where q * q no longer fits 32 bits
+      uint32_t q = 65536 - p;
+      return 65536 - (uint32_t)(((uint64_t)q * q) >> 16);
+    }
+    case EASE_IN_OUT: {
+      // 3p^2 - 2p^3
+      uint32_t p2 = (p * p) >> 16;
+      uint32_t p3 = (uint32_t)(((uint64_t)p2 * p) >> 16);
+      return 3 * p2 - 2 * p3;
+    }
+    case EASE_STEP:
+      return 0;
+    default:
+      return p;
+  }
+}
+
+static inline uint8_t rampValue(const ChannelRamp& ramp, uint32_t now) {
+  uint32_t elapsed = now - ramp.start;
+  if (elapsed >= ramp.duration) {
+    return ramp.to;
+  }
+  uint32_t p = (uint32_t)(((uint64_t)elapsed * ramp.rate) >> 16);
+  int32_t delta = (int32_t)ramp.to - ramp.from;
+  return ramp.from + ((delta * (int32_t)ease(ramp.easing, p)) >> 16);
+}
+
+// ==================== TRACK EVENTS ====================
+static void startRamps(const Keyframe& key, uint32_t at) {
+  uint64_t mask = ((uint64_t)key.maskHigh << 32) | key.maskLow;
+  mask &= NUM_MOTORS >= 64 ? ~0ULL : ((1ULL << NUM_MOTORS) - 1);
+
+  while (mask) {
+    int i = __builtin_ctzll(mask);
+    mask &= mask - 1;
+
+    ChannelRamp& ramp = ramps[i];
+    ramp.from = (activeRamps >> i) & 1 ? rampValue(ramp, at) : values[i];
+    ramp.to = key.value;
+    ramp.easing = key.easing;
+    ramp.start = at;
+    ramp.duration = key.arg;
+    ramp.rate = key.arg ? (uint32_t)((1ULL << 32) / key.arg) : 0;
+    activeRamps |= 1ULL << i;
+  }
+}
+
+// Consumes every record due by now; returns false once playback ends
+static bool advanceCursor(uint32_t now) {
+  while (cursor < trackLength && now - origin >= track[cursor].timeMs) {
+    const Keyframe& key = track[cursor];
+
+    switch (key.op) {
+      case SEQ_OP_KEY:
+        startRamps(key, origin + key.timeMs);
+        cursor++;
+        break;
+
+      case SEQ_OP_JUMP: {
+        int target = key.arg & 0xFFFF;
+        int repeats = key.arg >> 16;
+        if (repeats == 0 || jumpCounts[cursor] < repeats) {
+          jumpCounts[cursor]++;
+          // Inner loops start counting afresh on each outer pass
+          for (int j = target; j < cursor; j++) {
+            jumpCounts[j] = 0;
+          }
+          origin += key.timeMs - track[target].timeMs;
+          cursor = target;
+        }
+        else {
+          cursor++;
+        }
+        break;
+      }
+
+      case SEQ_OP_END:
+      default:
+        cursor = trackLength;
+        return false;
+    }
+  }
+  return cursor < trackLength;
+}
+
+// ==================== PUBLIC API ====================
+void clearSequence() {
+  stopSequence();
+  ramKeyCount = 0;
+}
+
+// Records must arrive in time order; a jump must land strictly earlier
+// in time so a loop always consumes time
+bool validKeyframe(const Keyframe& key, const Keyframe* earlier, int count) {
+  if (key.op > SEQ_OP_END || (count > 0 && key.timeMs < earlier[count - 1].timeMs)) {
+    return false;
+  }
+  if (key.op == SEQ_OP_KEY && key.easing >= EASING_COUNT) {
+    return false;
+  }
+  if (key.op == SEQ_OP_JUMP) {
+    int target = key.arg & 0xFFFF;
+    if (target >= count || earlier[target].timeMs >= key.timeMs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool addKeyframe(const Keyframe& key) {
+  if (ramKeyCount >= SEQ_MAX_KEYFRAMES || !validKeyframe(key, ramTrack, ramKeyCount)) {
+    return false;
+  }
+
+  if (track == ramTrack) {
+    stopSequence();
+  }
+  ramTrack[ramKeyCount++] = key;
+  return true;
+}
+
+bool playTrack(const Keyframe* keys, int count, unsigned long now) {
+  if (count <= 0 || count > SEQ_MAX_KEYFRAMES) {
+    return false;
+  }
+
+  track = keys;
+  trackLength = count;
+  cursor = 0;
+  origin = now;
+  lastTick = now - SEQ_TICK_MS;
+  activeRamps = 0;
+  memset(jumpCounts, 0, sizeof(jumpCounts));
+  playing = true;
+  return true;
+}
+
+bool startSequence(unsigned long now) {
+  return playTrack(ramTrack, ramKeyCount, now);
+}
+
+void stopSequence() {
+  playing = false;
+  activeRamps = 0;
+}
+
+// True while playing a track stored inside [start, start + length), so a
+// mapped flash region is not released under the cursor
+bool sequencerUsesTrack(const void* start, size_t length) {
+  const uint8_t* base = (const uint8_t*)start;
+  const uint8_t* keys = (const uint8_t*)track;
+  return playing && keys >= base && keys < base + length;
+}
+
+SequencerStatus getSequencerStatus(unsigned long now) {
+  SequencerStatus status;
+  status.playing = playing;
+  status.cursor = cursor;
+  status.keyCount = trackLength;
+  status.trackTime = playing ? now - origin : 0;
+  return status;
+}
+
+bool parseEasing(const char* name, Easing& easing) {
+  for (int i = 0; i < EASING_COUNT; i++) {
+    if (strcmp(name, EASING_NAMES[i]) == 0) {
+      easing = (Easing)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ==================== TICK ====================
+bool sequencerTick(unsigned long now, MotorFrame& frame) {
+  if (!playing || now - lastTick < (unsigned long)SEQ_TICK_MS) {
+    return false;
+  }
+  lastTick = now;
+
+  if (!advanceCursor(now) && !activeRamps) {
+    playing = false;
+  }
+
+  // Only channels with a running ramp need evaluating
+  uint64_t active = activeRamps;
+  while (active) {
+    int i = __builtin_ctzll(active);
+    active &= active - 1;
+
+    values[i] = rampValue(ramps[i], now);
+    if (now - ramps[i].start >= ramps[i].duration) {
+      activeRamps &= ~(1ULL << i);
+    }
+  }
+
+  bool changed = false;
+  Motors::forEach([&](int i) {
+    if (frame.values[i] != values[i]) {
+      frame.values[i] = values[i];
+      changed = true;
+    }
+  });
+  return changed;
+}
@@ -0,0 +1,87 @@
+/*
+ * Smart Sheet - Keyframe sequencer
+ * Plays a track of timed keyframes on-device, so long choreographed
+ * sessions run without the app holding the link open.
+ *
+ * A KEY record starts a ramp at its time: every channel in its mask moves
+ * from its current value to the key's value over the key's duration,
+ * shaped by an easing curve. JUMP records loop back to an earlier record
+ * (a fixed number of times, or forever) and END stops playback, holding
+ * the last values.
+ *
+ * Playback only moves a cursor forward through the track and updates the
+ * channels' running ramps, so per-tick work does not depend on track
+ * length. Ramps are integer-only.
+ *
+ * Records are a fixed 20-byte little-endian layout so tracks can be
+ * played straight out of flash as well as from RAM.
+ */
+
+#ifndef SMARTSHEET_SEQUENCER_H
+#define SMARTSHEET_SEQUENCER_H
+
+#include <Arduino.h>
+#include "frame.h"
+
+// ==================== SEQUENCER LIMITS ====================
+const int SEQ_MAX_KEYFRAMES = 128;         // RAM track capacity
+const int SEQ_TICK_MS = 10;                // Output update rate while ramping
+const long SEQ_JUMP_FIELD_MAX = 0xFFFF;    // JUMP target and repeats are 16 bits each
+
+enum KeyframeOp {
+  SEQ_OP_KEY,
+  SEQ_OP_JUMP,
+  SEQ_OP_END
+};
+
+enum Easing {
+  EASE_LINEAR,
+  EASE_IN,                                 // Quadratic, slow start
+  EASE_OUT,                                // Quadratic, slow finish
+  EASE_IN_OUT,                             // Smoothstep
+  EASE_STEP,                               // Hold, then jump at the end
+  EASING_COUNT
+};
+
+struct Keyframe {
+  uint32_t timeMs;                         // From track start
+  uint32_t arg;                            // KEY: ramp ms, JUMP: target | repeats << 16
+  uint32_t maskLow;                        // KEY: channels 0-31
+  uint32_t maskHigh;                       // KEY: channels 32-63
+  uint8_t op;                              // KeyframeOp
+  uint8_t value;                           // KEY: target intensity
+  uint8_t easing;                          // KEY: Easing
+  uint8_t reserved;
+};
+
+static_assert(sizeof(Keyframe) == 20, "Keyframe records must stay 20 bytes");
+
+// JUMP arg helpers; zero repeats loops forever. Both fields must be in
+// 0..SEQ_JUMP_FIELD_MAX or they spill into each other
+static inline uint32_t jumpArg(int target, int repeats) {
+  return (uint32_t)target | ((uint32_t)repeats << 16);
+}
+
+struct SequencerStatus {
+  bool playing;
+  int cursor;
+  int keyCount;
+  uint32_t trackTime;
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+void clearSequence();
+bool validKeyframe(const Keyframe& key, const Keyframe* earlier, int count);
+bool addKeyframe(const Keyframe& key);
+bool playTrack(const Keyframe* keys, int count, unsigned long now);
+bool startSequence(unsigned long now);
+void stopSequence();
+bool sequencerUsesTrack(const void* start, size_t length);
+SequencerStatus getSequencerStatus(unsigned long now);
+bool parseEasing(const char* name, Easing& easing);
+
+// Advances the track to now and renders every channel; returns whether
+// the frame changed
+bool sequencerTick(unsigned long now, MotorFrame& frame);
+
+#endif
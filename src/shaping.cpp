@@ -0,0 +1,182 @@
+/*
+ * Smart Sheet - ERM transient shaping
+ * First-order motor model, transient timing and NVS persistence
+ */
+
+#include "shaping.h"
+#include <Preferences.h>
+
+// ==================== STORAGE KEYS ====================
+static const char* PREFS_NAMESPACE = "smartsheet";
+static const char* PREFS_SHAPE_KEY = "shape";
+static const char* PREFS_SHAPE_ON_KEY = "shape_on";
+
+// Longest transient, as a multiple of the time constant (~95% settled)
+const float SHAPE_MAX_TAU_MULTIPLE = 3.0f;
+
+// ==================== SHAPER STATE ====================
+struct ShaperState {
+  uint8_t target;                    // Duty the motor should settle at
+  uint8_t startSpeed;                // Modelled speed when the transient began
+  bool active;                       // Kick or brake in progress
+  unsigned long start;
+  unsigned long end;
+};
+
+static MotorModel models[NUM_MOTORS];
+static ShaperState states[NUM_MOTORS];
+static bool shapingEnabled = false;
+
+// ==================== HELPERS ====================
+static bool isValidModel(const MotorModel& model) {
+  return model.riseMs >= SHAPE_TAU_MIN && model.riseMs <= SHAPE_TAU_MAX &&
+         model.fallMs >= SHAPE_TAU_MIN && model.fallMs <= SHAPE_TAU_MAX;
+}
+
+// Modelled speed (in duty units) at time now
+static uint8_t modelledSpeed(const ShaperState& state, unsigned long now) {
+  if (!state.active || (long)(now - state.end) >= 0) {
+    return state.target;
+  }
+  long elapsed = now - state.start;
+  long duration = state.end - state.start;
+  return state.startSpeed + ((long)state.target - state.startSpeed) * elapsed / duration;
+}
+
+static void saveShaping() {
+  Preferences prefs;
+  if (!prefs.begin(PREFS_NAMESPACE, false)) {
+    Serial.println("ERROR: Failed to open shaping storage");
+    return;
+  }
+  prefs.putBytes(PREFS_SHAPE_KEY, models, sizeof(models));
+  prefs.putBytes(PREFS_SHAPE_ON_KEY, &shapingEnabled, sizeof(shapingEnabled));
+  prefs.end();
+}
+
+static bool loadShaping() {
+  Preferences prefs;
+  if (!prefs.begin(PREFS_NAMESPACE, true)) {
+    return false;
+  }
+
+  bool loaded = false;
+  if (prefs.getBytesLength(PREFS_SHAPE_KEY) == sizeof(models)) {
+    loaded = prefs.getBytes(PREFS_SHAPE_KEY, models, sizeof(models)) == sizeof(models);
+  }
+  if (loaded && prefs.getBytesLength(PREFS_SHAPE_ON_KEY) == sizeof(shapingEnabled)) {
+    prefs.getBytes(PREFS_SHAPE_ON_KEY, &shapingEnabled, sizeof(shapingEnabled));
+  }
+  prefs.end();
+
+  for (int i = 0; loaded && i < NUM_MOTORS; i++) {
+    loaded = isValidModel(models[i]);
+  }
+  return loaded;
+}
+
+// ==================== PUBLIC API ====================
+void initShaping() {
+  if (!loadShaping()) {
+    for (int i = 0; i < NUM_MOTORS; i++) {
+      models[i].riseMs = SHAPE_DEFAULT_RISE;
+      models[i].fallMs = SHAPE_DEFAULT_FALL;
+    }
+    shapingEnabled = false;
+  }
+
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    states[i].target = 0;
+    states[i].startSpeed = 0;
+    states[i].active = false;
+  }
+
+  Serial.printf("Shaping: %s\n", shapingEnabled ? "ON" : "OFF");
+}
+
+void setShapingEnabled(bool enabled) {
+  shapingEnabled = enabled;
+  saveShaping();
+}
+
+bool isShapingEnabled() {
+  return shapingEnabled;
+}
+
+bool setMotorModel(int motor, const MotorModel& model) {
+  if (motor < 0 || motor >= NUM_MOTORS || !isValidModel(model)) {
+    return false;
+  }
+
+  models[motor] = model;
+  saveShaping();
+  return true;
+}
+
+const MotorModel& getMotorModel(int motor) {
+  return models[motor];
+}
+
+// ==================== COMMIT PATH ====================
+uint8_t shapeDuty(int motor, uint8_t targetDuty, unsigned long now) {
+  ShaperState& state = states[motor];
+  uint8_t speed = modelledSpeed(state, now);
+
+  state.target = targetDuty;
+  state.active = false;
+
+  // Nothing to shape: disabled, already there, or settling at an end stop
+  if (!shapingEnabled || targetDuty == speed ||
+      targetDuty == 0 || targetDuty == PWM_MAX_DUTY) {
+    return targetDuty;
+  }
+
+  // Time for a first-order system to move from speed to target when driven
+  // at full (rising) or zero (falling) duty
+  float tau;
+  float ratio;
+  uint8_t drive;
+  if (targetDuty > speed) {
+    tau = models[motor].riseMs;
+    ratio = (float)(PWM_MAX_DUTY - speed) / (PWM_MAX_DUTY - targetDuty);
+    drive = PWM_MAX_DUTY;
+  } else {
+    tau = models[motor].fallMs;
+    ratio = speed == 0 ? 1.0f : (float)speed / targetDuty;
+    drive = 0;
+  }
+
+  float duration = tau * logf(ratio);
+  if (duration > tau * SHAPE_MAX_TAU_MULTIPLE) {
+    duration = tau * SHAPE_MAX_TAU_MULTIPLE;
+  }
+  if (duration < 1.0f) {
+    return targetDuty;  // Shorter than one tick, not worth a transient
+  }
+
+  state.startSpeed = speed;
+  state.start = now;
+  state.end = now + (unsigned long)duration;
+  state.active = true;
+  return drive;
+}
+
+// ==================== TICK PATH ====================
+int shapingTick(int motor, unsigned long now) {
+  ShaperState& state = states[motor];
+  if (!state.active || (long)(now - state.end) < 0) {
+    return -1;
+  }
+  state.active = false;
+  return state.target;
+}
+
+// A transient drives full or zero duty until it ends; a transient that
+// is over but not yet ticked is reported as settled
+uint8_t appliedDuty(int motor, unsigned long now) {
+  const ShaperState& state = states[motor];
+  if (!state.active || (long)(now - state.end) >= 0) {
+    return state.target;
+  }
+  return state.target > state.startSpeed ? PWM_MAX_DUTY : 0;
+}
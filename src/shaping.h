@@ -0,0 +1,47 @@
+/*
+ * Smart Sheet - ERM transient shaping
+ * Optional overdrive kick / brake stage applied to calibrated duty.
+ *
+ * An ERM motor behaves roughly like a first-order system: its speed
+ * approaches the applied duty with a time constant of 50-100 ms. When the
+ * commanded duty rises, the shaper drives full duty for just long enough
+ * for the modelled speed to reach the target, then settles at the target.
+ * When it falls, the shaper drops to zero for the modelled coast time.
+ * The drive stage is single-ended, so "brake" means coast at zero duty;
+ * there is no reverse drive.
+ */
+
+#ifndef SMARTSHEET_SHAPING_H
+#define SMARTSHEET_SHAPING_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ==================== MODEL LIMITS ====================
+const int SHAPE_TAU_MIN = 5;         // ms
+const int SHAPE_TAU_MAX = 500;       // ms
+const int SHAPE_DEFAULT_RISE = 60;   // ms, spin-up time constant
+const int SHAPE_DEFAULT_FALL = 80;   // ms, spin-down time constant
+
+struct MotorModel {
+  uint16_t riseMs;                   // Spin-up time constant
+  uint16_t fallMs;                   // Spin-down time constant
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initShaping();
+void setShapingEnabled(bool enabled);
+bool isShapingEnabled();
+bool setMotorModel(int motor, const MotorModel& model);
+const MotorModel& getMotorModel(int motor);
+
+// Commit path: returns the duty to write now for a new target duty
+uint8_t shapeDuty(int motor, uint8_t targetDuty, unsigned long now);
+
+// Tick path: returns the settled duty once a transient ends, else -1
+int shapingTick(int motor, unsigned long now);
+
+// Duty the commit and tick paths currently have on the output
+uint8_t appliedDuty(int motor, unsigned long now);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Smart Sheet - Loop stall detector
+ */
+
+#include "stall.h"
+
+// ==================== GLOBAL VARIABLES ====================
+StallState stall;
+
+static const char* const stageNames[STALL_STAGES] = {
+  "RX", "CMD", "UPLOAD", "PATTERN", "SHAPING", "LOOP"
+};
+
+// Defaults sit well above a normal iteration but below what shows up as
+// a visible hiccup in a 50 ms wave step
+static const uint32_t defaultLimitsUs[STALL_STAGES] = {
+  10000, 20000, 20000, 5000, 2000, 25000
+};
+
+static uint32_t limitUs[STALL_STAGES];
+static uint32_t overruns[STALL_STAGES];
+static uint32_t worstUs[STALL_STAGES];
+
+static StallEvent events[STALL_LOG_SIZE];
+static uint32_t eventCount = 0;      // Total logged; the ring keeps the newest
+
+// ==================== LIMITS ====================
+static void applyLimit(int stage, uint32_t us) {
+  limitUs[stage] = us;
+  uint64_t cycles = (uint64_t)us * Clock::cyclesPerMicro();
+  stall.limit[stage] = us == 0 || cycles > UINT32_MAX ? UINT32_MAX : (uint32_t)cycles;
+}
+
+void initStall() {
+  for (int s = 0; s < STALL_STAGES; s++) {
+    applyLimit(s, defaultLimitsUs[s]);
+  }
+  clearStallLog();
+  stallLoopBegin();
+}
+
+bool setStallLimit(const String& stage, uint32_t us) {
+  if (us > STALL_MAX_LIMIT_US) {
+    return false;
+  }
+  for (int s = 0; s < STALL_STAGES; s++) {
+    if (stage == stageNames[s]) {
+      applyLimit(s, us);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* stallStageName(int stage) {
+  return stage >= 0 && stage < STALL_STAGES ? stageNames[stage] : "?";
+}
+
+// ==================== EVENT LOG ====================
+void stallOverrun(StallStage stage, uint32_t cycles, const char* link) {
+  uint32_t us = cycles / Clock::cyclesPerMicro();
+  overruns[stage]++;
+  if (us > worstUs[stage]) {
+    worstUs[stage] = us;
+  }
+
+  StallEvent& event = events[eventCount % STALL_LOG_SIZE];
+  event.ms = Clock::millis();
+  event.stage = stage;
+  event.link = link;
+  event.us = us;
+  event.limitUs = limitUs[stage];
+  eventCount++;
+
+  // Logging took time too; keep it out of the next stage
+  stall.mark = Clock::cycles();
+}
+
+void clearStallLog() {
+  memset(overruns, 0, sizeof(overruns));
+  memset(worstUs, 0, sizeof(worstUs));
+  eventCount = 0;
+}
+
+int getStallEvents(StallEvent* copy, int max) {
+  int count = eventCount < (uint32_t)STALL_LOG_SIZE ? eventCount : STALL_LOG_SIZE;
+  if (count > max) {
+    count = max;
+  }
+  uint32_t first = eventCount - count;
+  for (int k = 0; k < count; k++) {
+    copy[k] = events[(first + k) % STALL_LOG_SIZE];
+  }
+  return count;
+}
+
+// ==================== FORMATTING ====================
+String formatStall() {
+  String text = "STALL:";
+  for (int s = 0; s < STALL_STAGES; s++) {
+    text += stageNames[s];
+    text += ":" + String(overruns[s]) + "/" + String(worstUs[s]) + "/" + String(limitUs[s]) + ",";
+  }
+  text += "EVENTS:" + String(eventCount);
+  return text;
+}
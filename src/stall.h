@@ -0,0 +1,91 @@
+/*
+ * Smart Sheet - Loop stall detector
+ * loop() marks the end of each of its stages with stallStage(); the time
+ * since the previous mark is compared with that stage's limit, and only
+ * an overrun does any further work: it is counted and written to a small
+ * ring of events. The whole iteration is checked against the LOOP limit
+ * by stallLoopEnd(). Every mark is one cycle counter read and a compare,
+ * so stages are timed in cycles and durations beyond the counter's wrap
+ * (about 17 s at 240 MHz) go unseen.
+ *
+ *   RX       Transport::poll(); events name the link that was read (BT,
+ *            SERIAL) - a partial line blocks in readStringUntil()
+ *   CMD      processCommand() including its debug print and reply
+ *   UPLOAD   servicing a bulk upload
+ *   PATTERN  executePattern() and the output pipeline
+ *   SHAPING  kick/brake settling
+ *   LOOP     the whole iteration
+ *
+ * STALL replies STALL:<stage>:<overruns>/<worst us>/<limit us>,...,EVENTS:<n>
+ * STALL:LOG sends STALL:EVENT:<ms>:<stage>[_<link>]:<us>:<limit us> per
+ * logged event, oldest first, then OK:STALL:LOG:<n>. STALL:CLEAR empties
+ * both and STALL:<stage>:<us> sets a limit (0 turns the stage off).
+ */
+
+#ifndef SMARTSHEET_STALL_H
+#define SMARTSHEET_STALL_H
+
+#include <Arduino.h>
+#include "hal/clock.h"
+
+const int STALL_LOG_SIZE = 16;
+const uint32_t STALL_MAX_LIMIT_US = 10000000;
+
+enum StallStage {
+  STALL_RX,
+  STALL_CMD,
+  STALL_UPLOAD,
+  STALL_PATTERN,
+  STALL_SHAPING,
+  STALL_LOOP,
+  STALL_STAGES
+};
+
+struct StallEvent {
+  unsigned long ms;                  // Clock::millis() when detected
+  uint8_t stage;
+  const char* link;                  // RX only, NULL otherwise
+  uint32_t us;
+  uint32_t limitUs;
+};
+
+struct StallState {
+  uint32_t loopStart;
+  uint32_t mark;
+  uint32_t limit[STALL_STAGES];      // Cycles, UINT32_MAX when off
+};
+
+extern StallState stall;
+
+// ==================== FUNCTION DECLARATIONS ====================
+void initStall();
+void stallOverrun(StallStage stage, uint32_t cycles, const char* link);
+bool setStallLimit(const String& stage, uint32_t us);
+void clearStallLog();
+String formatStall();
+int getStallEvents(StallEvent* events, int max);   // Oldest first
+const char* stallStageName(int stage);
+
+// ==================== MARKS ====================
+static inline void stallLoopBegin() {
+  stall.loopStart = stall.mark = Clock::cycles();
+}
+
+// Ends the stage that began at the previous mark
+static inline void stallStage(StallStage stage, const char* link = NULL) {
+  uint32_t now = Clock::cycles();
+  uint32_t elapsed = now - stall.mark;
+  stall.mark = now;
+  if (elapsed > stall.limit[stage]) {
+    stallOverrun(stage, elapsed, link);
+  }
+}
+
+static inline void stallLoopEnd() {
+  uint32_t elapsed = Clock::cycles() - stall.loopStart;
+  if (elapsed > stall.limit[STALL_LOOP]) {
+    stallOverrun(STALL_LOOP, elapsed, NULL);
+  }
+}
+
+#endif
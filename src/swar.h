@@ -0,0 +1,71 @@
+/*
+ * Smart Sheet - SWAR byte-lane arithmetic
+ * Operates on four 8-bit intensities packed in one 32-bit word, so frame
+ * blending costs a handful of ALU ops per four motors instead of a
+ * branch-and-clamp per motor.
+ */
+
+#ifndef SMARTSHEET_SWAR_H
+#define SMARTSHEET_SWAR_H
+
+#include <stdint.h>
+
+const uint32_t SWAR_HIGH = 0x80808080;   // Top bit of every lane
+const uint32_t SWAR_LOW7 = 0x7F7F7F7F;   // Lower 7 bits of every lane
+const uint32_t SWAR_EVEN = 0x00FF00FF;   // Lanes 0 and 2
+
+// Spreads each lane's top bit across the lane: 0x80 -> 0xFF
+static inline uint32_t swarLaneMask(uint32_t highBits) {
+  return (highBits >> 7) * 0xFF;
+}
+
+// Per-lane a + b, clamped at 255
+static inline uint32_t swarAddSat(uint32_t a, uint32_t b) {
+  uint32_t low = (a & SWAR_LOW7) + (b & SWAR_LOW7);
+  uint32_t carry = ((a & b) | ((a | b) & low)) & SWAR_HIGH;
+  uint32_t sum = low ^ ((a ^ b) & SWAR_HIGH);
+  return sum | swarLaneMask(carry);
+}
+
+// Per-lane a - b, clamped at 0
+static inline uint32_t swarSubSat(uint32_t a, uint32_t b) {
+  uint32_t diff = ((a | SWAR_HIGH) - (b & SWAR_LOW7)) ^ ((a ^ ~b) & SWAR_HIGH);
+  uint32_t borrow = ((~a & b) | (~(a ^ b) & diff)) & SWAR_HIGH;
+  return diff & ~swarLaneMask(borrow);
+}
+
+// Per-lane max; b + (a - b)+ never overflows a lane, so a plain add works
+static inline uint32_t swarMax(uint32_t a, uint32_t b) {
+  return b + swarSubSat(a, b);
+}
+
+// Per-lane x * s / 256 for a scalar s in 0..256: two lanes per multiply,
+// each 16-bit product has room for 255 * 256
+static inline uint32_t swarScale(uint32_t x, uint32_t s) {
+  uint32_t even = (((x & SWAR_EVEN) * s) >> 8) & SWAR_EVEN;
+  uint32_t odd = (((x >> 8) & SWAR_EVEN) * s) & ~SWAR_EVEN;
+  return even | odd;
+}
+
+// Per-lane a * (256 - s) / 256 + b * s / 256; lanes cannot overflow
+static inline uint32_t swarLerp(uint32_t a, uint32_t b, uint32_t s) {
+  return swarScale(a, 256 - s) + swarScale(b, s);
+}
+
+// Per-lane a * b / 256. Both operands vary per lane, which SWAR multiply
+// cannot do, so this unpacks to four byte multiplies.
+static inline uint32_t swarMultiply(uint32_t a, uint32_t b) {
+  uint32_t out = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    uint32_t product = ((a >> shift) & 0xFF) * (((b >> shift) & 0xFF) + 1);
+    out |= (product >> 8) << shift;
+  }
+  return out;
+}
+
+// Maps an 8-bit opacity to the 0..256 scale used above, so 255 is exact
+static inline uint32_t swarOpacity(uint8_t opacity) {
+  return opacity + (opacity >> 7);
+}
+
+#endif
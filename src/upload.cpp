@@ -0,0 +1,243 @@
+/*
+ * Smart Sheet - Bulk library upload
+ * Chunk framing, go-back-N acknowledgement and direct flash writes
+ */
+
+#include "upload.h"
+#include "library.h"
+#include "rom/crc.h"
+
+const uint32_t FLASH_SECTOR_SIZE = 4096;
+
+// ==================== GLOBAL VARIABLES ====================
+struct UploadState {
+  const esp_partition_t* partition;
+  uint32_t size;
+  uint32_t crc;
+  uint32_t committed;                        // Bytes written and acknowledged
+  uint32_t erased;                           // Sectors erased so far, in bytes
+  uint8_t magic[4];                          // Held back until the image verifies
+  bool valid;                                // A transfer is open (active or paused)
+  bool active;                               // Link is in binary mode
+  bool discarding;                           // After a NAK, until the host rewinds
+  unsigned long started;
+  unsigned long lastData;
+  uint32_t sessionBytes;
+};
+
+static UploadState upload;
+static UploadResult result;
+
+static uint8_t header[UPLOAD_HEADER_SIZE];
+static int headerFill = 0;
+static uint8_t chunk[UPLOAD_CHUNK_SIZE];
+static int chunkFill = 0;
+static int chunkLength = -1;                 // -1 while reading a header
+
+// ==================== HELPERS ====================
+static uint32_t readLE32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void sendAck(Stream& link, const char* kind) {
+  char line[24];
+  snprintf(line, sizeof(line), "%s:%lu", kind, (unsigned long)upload.committed);
+  link.println(line);
+}
+
+static void fillResult(UploadError error, unsigned long now) {
+  result.size = upload.size;
+  result.offset = upload.committed;
+  result.sessionBytes = upload.sessionBytes;
+  result.elapsedMs = now - upload.started;
+  result.error = error;
+}
+
+// ==================== TRANSFER CONTROL ====================
+UploadError beginUpload(uint32_t size, uint32_t crc, unsigned long now, uint32_t& resumeOffset) {
+  const esp_partition_t* partition = findLibraryPartition();
+  if (partition == NULL) {
+    return UPLOAD_ERR_NO_PARTITION;
+  }
+  if (size < sizeof(LibraryHeader) || size > partition->size) {
+    return UPLOAD_ERR_TOO_LARGE;
+  }
+
+  // The library is being replaced: stop anything playing from it
+  unmountLibrary();
+
+  // Sectors are erased as chunks reach them, so BEGIN never holds up
+  // loop() for a whole-image erase
+  bool resume = upload.valid && upload.size == size && upload.crc == crc;
+  if (!resume) {
+    upload.partition = partition;
+    upload.size = size;
+    upload.crc = crc;
+    upload.committed = 0;
+    upload.erased = 0;
+    upload.valid = true;
+  }
+
+  upload.active = true;
+  upload.discarding = false;
+  upload.started = now;
+  upload.lastData = now;
+  upload.sessionBytes = 0;
+  headerFill = 0;
+  chunkLength = -1;
+  resumeOffset = upload.committed;
+  return UPLOAD_OK;
+}
+
+void abortUpload() {
+  upload.valid = false;
+  upload.active = false;
+}
+
+bool isUploadActive() {
+  return upload.active;
+}
+
+const UploadResult& getUploadResult() {
+  return result;
+}
+
+// ==================== COMPLETION ====================
+// CRC the image as written (with the held-back magic in place), then
+// write the magic so the library can mount
+static UploadError finishUpload() {
+  uint8_t block[256];
+  uint32_t crc = crc32_le(0, upload.magic, 4);
+  for (uint32_t offset = 4; offset < upload.size; offset += sizeof(block)) {
+    uint32_t length = min((uint32_t)sizeof(block), upload.size - offset);
+    if (esp_partition_read(upload.partition, offset, block, length) != ESP_OK) {
+      return UPLOAD_ERR_FLASH;
+    }
+    crc = crc32_le(crc, block, length);
+  }
+  if (crc != upload.crc) {
+    return UPLOAD_ERR_CRC;
+  }
+  if (esp_partition_write(upload.partition, 0, upload.magic, 4) != ESP_OK) {
+    return UPLOAD_ERR_FLASH;
+  }
+  return UPLOAD_OK;
+}
+
+// ==================== CHUNK HANDLING ====================
+// Returns false on a flash failure
+static bool acceptChunk(Stream& link, uint32_t offset, uint32_t crc) {
+  if (offset != upload.committed) {
+    // Duplicate of acknowledged data, or still in flight after a NAK
+    if (offset < upload.committed) {
+      sendAck(link, "ACK");
+    }
+    else if (!upload.discarding) {
+      upload.discarding = true;
+      sendAck(link, "NAK");
+    }
+    return true;
+  }
+
+  if (crc32_le(0, chunk, chunkLength) != crc) {
+    upload.discarding = true;
+    sendAck(link, "NAK");
+    return true;
+  }
+  upload.discarding = false;
+
+  // One sector erase at a time (tens of ms) keeps each stall short
+  while (upload.erased < offset + chunkLength) {
+    if (esp_partition_erase_range(upload.partition, upload.erased, FLASH_SECTOR_SIZE) != ESP_OK) {
+      return false;
+    }
+    upload.erased += FLASH_SECTOR_SIZE;
+  }
+
+  // Flash bits only clear, so the magic bytes stay erased for later; they
+  // may arrive split over several short chunks
+  if (offset < 4) {
+    uint32_t held = min((uint32_t)chunkLength, 4 - offset);
+    memcpy(upload.magic + offset, chunk, held);
+    memset(chunk, 0xFF, held);
+  }
+  if (esp_partition_write(upload.partition, offset, chunk, chunkLength) != ESP_OK) {
+    return false;
+  }
+  upload.committed += chunkLength;
+  sendAck(link, "ACK");
+  return true;
+}
+
+// Header fields are sanity-checked before trusting the length; a bad
+// header drops one byte and rescans for the sync pattern
+static bool parseHeader() {
+  if (header[0] != UPLOAD_SYNC0 || header[1] != UPLOAD_SYNC1) {
+    return false;
+  }
+  uint32_t offset = readLE32(&header[2]);
+  int length = header[6] | (header[7] << 8);
+  if (length == 0 || length > UPLOAD_CHUNK_SIZE || offset > upload.size ||
+      length > (int)(upload.size - offset)) {
+    return false;
+  }
+  chunkLength = length;
+  chunkFill = 0;
+  return true;
+}
+
+UploadEvent serviceUpload(Stream& link, bool connected, unsigned long now) {
+  if (!upload.active) {
+    return UPLOAD_RUNNING;
+  }
+
+  int available = link.available();
+  while (available > 0) {
+    upload.lastData = now;
+    if (chunkLength < 0) {
+      int take = min(available, UPLOAD_HEADER_SIZE - headerFill);
+      link.readBytes(&header[headerFill], take);
+      headerFill += take;
+      available -= take;
+      if (headerFill == UPLOAD_HEADER_SIZE && !parseHeader()) {
+        memmove(header, header + 1, UPLOAD_HEADER_SIZE - 1);
+        headerFill--;
+      }
+      continue;
+    }
+
+    int take = min(available, chunkLength - chunkFill);
+    link.readBytes(&chunk[chunkFill], take);
+    chunkFill += take;
+    available -= take;
+    upload.sessionBytes += take;
+    if (chunkFill < chunkLength) {
+      continue;
+    }
+
+    uint32_t offset = readLE32(&header[2]);
+    uint32_t crc = readLE32(&header[8]);
+    bool written = acceptChunk(link, offset, crc);
+    headerFill = 0;
+    chunkLength = -1;
+
+    if (!written) {
+      fillResult(UPLOAD_ERR_FLASH, now);
+      abortUpload();
+      return UPLOAD_FAILED;
+    }
+    if (upload.committed == upload.size) {
+      UploadError error = finishUpload();
+      fillResult(error, now);
+      abortUpload();
+      return error == UPLOAD_OK ? UPLOAD_DONE : UPLOAD_FAILED;
+    }
+  }
+
+  if (!connected || now - upload.lastData >= UPLOAD_IDLE_MS) {
+    upload.active = false;
+    fillResult(UPLOAD_OK, now);
+    return UPLOAD_PAUSED;
+  }
+  return UPLOAD_RUNNING;
+}
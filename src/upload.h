@@ -0,0 +1,70 @@
+/*
+ * Smart Sheet - Bulk library upload
+ * Replaces the flash pattern library image over SPP in binary chunks,
+ * instead of line-by-line text commands.
+ *
+ * UPLOAD:BEGIN:<size>:<crc32 hex> checks the size against the partition,
+ * answers OK:UPLOAD:<resume offset>:<chunk size>:<window> and switches the
+ * link to binary. The host then streams chunks, keeping at most <window> of them
+ * unacknowledged:
+ *
+ *   A5 5A | offset u32 | length u16 | crc32 u32 | payload      (little-endian)
+ *
+ * Each good chunk is written straight to flash, erasing each 4 KB sector
+ * just before the first chunk that reaches it, and answered with a
+ * cumulative ACK:<next offset>. A bad CRC, or a gap left by bytes the SPP
+ * receive queue dropped, is answered with NAK:<next offset>. Later chunks
+ * are then ignored until the host goes back to that offset (go-back-N).
+ *
+ * If the link drops or goes idle, the transfer pauses in text mode.
+ * Repeating UPLOAD:BEGIN with the same size and CRC resumes from the last
+ * acknowledged byte. The image's magic is written only after the whole
+ * image verifies, so a partial upload never mounts.
+ */
+
+#ifndef SMARTSHEET_UPLOAD_H
+#define SMARTSHEET_UPLOAD_H
+
+#include <Arduino.h>
+
+// ==================== UPLOAD PROTOCOL ====================
+const int UPLOAD_CHUNK_SIZE = 1024;
+const int UPLOAD_WINDOW = 4;                   // Chunks in flight
+const int UPLOAD_HEADER_SIZE = 12;
+const uint8_t UPLOAD_SYNC0 = 0xA5;
+const uint8_t UPLOAD_SYNC1 = 0x5A;
+const unsigned long UPLOAD_IDLE_MS = 3000;     // Pause after this long without data
+
+enum UploadError {
+  UPLOAD_OK,
+  UPLOAD_ERR_NO_PARTITION,
+  UPLOAD_ERR_TOO_LARGE,
+  UPLOAD_ERR_FLASH,
+  UPLOAD_ERR_CRC
+};
+
+enum UploadEvent {
+  UPLOAD_RUNNING,
+  UPLOAD_DONE,
+  UPLOAD_PAUSED,
+  UPLOAD_FAILED
+};
+
+struct UploadResult {
+  uint32_t size;
+  uint32_t offset;                             // Bytes acknowledged so far
+  uint32_t sessionBytes;                       // Received since the last BEGIN
+  uint32_t elapsedMs;
+  UploadError error;
+};
+
+// ==================== FUNCTION DECLARATIONS ====================
+UploadError beginUpload(uint32_t size, uint32_t crc, unsigned long now, uint32_t& resumeOffset);
+void abortUpload();
+bool isUploadActive();
+
+// Consumes whatever the link has buffered, writes ACK/NAK lines back to it
+UploadEvent serviceUpload(Stream& link, bool connected, unsigned long now);
+const UploadResult& getUploadResult();
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Smart Sheet - Cycle cache tests
+ * Runs the real compile task (a host thread here) and checks lookups:
+ * misses until a table is published, back-to-back requests that must
+ * all get compiled without loop() reading in between, and a reader
+ * racing constant republication that must never see a mixed frame.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "cycle_cache.h"
+
+// ==================== HELPERS ====================
+// Every motor of step s in the table for key k holds (k + s) & 0xFF, so a
+// frame mixing two tables or two steps is easy to spot
+static void renderTest(const PatternLayer& params, int step, MotorFrame& frame) {
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    frame.values[i] = (params.intensity + step) & 0xFF;
+    if (i % 2) {
+      std::this_thread::yield();       // Widen the window for a racing reader
+    }
+  }
+}
+
+static void request(int layerId, uint32_t key) {
+  PatternLayer params;
+  initPatternLayer(params, layerId);
+  params.intensity = key;
+  requestCycleCompile(layerId, key, params, renderTest, CYCLE_MAX_PERIOD);
+}
+
+static bool consistent(const MotorFrame& frame, uint32_t key, int step) {
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    if (frame.values[i] != ((key + step) & 0xFF)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Polls until the table for key is live, as loop() would every step
+static bool waitForHit(int layerId, uint32_t key, MotorFrame& frame) {
+  for (int attempt = 0; attempt < 2000; attempt++) {
+    if (cachedCycleFrame(layerId, key, 0, frame)) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ==================== TESTS ====================
+void test_budget_covers_every_layer() {
+  TEST_ASSERT_EQUAL_INT(MAX_LAYERS, CYCLE_ENTRIES);
+}
+
+void test_miss_until_published() {
+  MotorFrame frame;
+  TEST_ASSERT_FALSE(cachedCycleFrame(0, 10, 0, frame));
+
+  request(0, 10);
+  TEST_ASSERT_TRUE(waitForHit(0, 10, frame));
+  for (int step = 0; step < CYCLE_MAX_PERIOD; step++) {
+    TEST_ASSERT_TRUE(cachedCycleFrame(0, 10, step, frame));
+    TEST_ASSERT_TRUE(consistent(frame, 10, step));
+  }
+
+  // Other keys and layers are not served from this table
+  TEST_ASSERT_FALSE(cachedCycleFrame(0, 11, 0, frame));
+  TEST_ASSERT_FALSE(cachedCycleFrame(1, 10, 0, frame));
+  TEST_ASSERT_FALSE(cachedCycleFrame(CYCLE_ENTRIES, 10, 0, frame));
+}
+
+// Publishing A, reading it, then requesting B and C with no read in
+// between used to leave the compile task waiting forever for loop()
+void test_requests_without_reads_all_compile() {
+  MotorFrame frame;
+  request(1, 20);
+  TEST_ASSERT_TRUE(waitForHit(1, 20, frame));
+
+  request(1, 21);
+  request(1, 22);
+  TEST_ASSERT_TRUE(waitForHit(1, 22, frame));
+  TEST_ASSERT_TRUE(consistent(frame, 22, 0));
+
+  // And again straight away, alternating tables
+  for (uint32_t key = 23; key < 30; key++) {
+    request(1, key);
+  }
+  TEST_ASSERT_TRUE(waitForHit(1, 29, frame));
+}
+
+void test_reader_never_sees_a_torn_frame() {
+  const uint32_t firstKey = 100;
+  const int keys = 4;
+  std::atomic<bool> done(false);
+  std::atomic<int> hits(0);
+  std::atomic<int> torn(0);
+
+  std::thread reader([&]() {
+    MotorFrame frame;
+    int step = 0;
+    while (!done) {
+      for (uint32_t k = firstKey; k < firstKey + keys; k++) {
+        if (cachedCycleFrame(2, k, step, frame)) {
+          hits++;
+          if (!consistent(frame, k, step)) {
+            torn++;
+          }
+        }
+      }
+      step = (step + 1) % CYCLE_MAX_PERIOD;
+    }
+  });
+
+  auto stop = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+  // Cycling through a few keys keeps the task rewriting both tables
+  for (int n = 0; std::chrono::steady_clock::now() < stop; n++) {
+    request(2, firstKey + n % keys);
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  done = true;
+  reader.join();
+
+  TEST_ASSERT_GREATER_THAN(0, hits.load());
+  TEST_ASSERT_EQUAL_INT(0, torn.load());
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  initCycleCache();
+  UNITY_BEGIN();
+  RUN_TEST(test_budget_covers_every_layer);
+  RUN_TEST(test_miss_until_published);
+  RUN_TEST(test_requests_without_reads_all_compile);
+  RUN_TEST(test_reader_never_sees_a_torn_frame);
+  return UNITY_END();
+}
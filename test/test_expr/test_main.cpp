@@ -0,0 +1,207 @@
+/*
+ * Smart Sheet - Pattern expression tests
+ * Compiler output, constant folding against the interpreter, the Q16.16
+ * sine table, the division and modulo guards, compile limits and the
+ * clamped render.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "expr.h"
+
+// ==================== HELPERS ====================
+const int32_t ONE = 1 << 16;
+
+static ExprProgram program;
+
+static ExprInputs inputs(double t, int n, int intensity) {
+  ExprInputs in;
+  in.t = (int32_t)lround(t * ONE);
+  in.n = n << 16;
+  in.intensity = intensity << 16;
+  return in;
+}
+
+static int32_t eval(const char* source, int index = 0, const ExprInputs& in = inputs(0, 8, 255)) {
+  int errorPos = -1;
+  ExprError error = compileExpression(source, program, errorPos);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(EXPR_OK, error, source);
+  return evaluateExpression(program, in, index << 16);
+}
+
+static ExprError compileError(const char* source, int& errorPos) {
+  ExprProgram scratch;
+  return compileExpression(source, scratch, errorPos);
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ==================== COMPILER ====================
+void test_arithmetic_and_precedence() {
+  TEST_ASSERT_EQUAL_INT32(14 * ONE, eval("2+3*4"));
+  TEST_ASSERT_EQUAL_INT32(20 * ONE, eval("(2+3)*4"));
+  TEST_ASSERT_EQUAL_INT32(6 * ONE, eval("-(2-5)*2"));
+  TEST_ASSERT_EQUAL_INT32(2 * ONE, eval("0.5*4"));
+  TEST_ASSERT_EQUAL_INT32(ONE / 4, eval("1/4"));
+  TEST_ASSERT_EQUAL_INT32(ONE, eval("7 % 3"));
+  TEST_ASSERT_EQUAL_INT32(3 * ONE, eval("floor(3.75)"));
+  TEST_ASSERT_EQUAL_INT32(3 * ONE / 4, eval("frac(3.75)"));
+  TEST_ASSERT_EQUAL_INT32(2 * ONE, eval("abs(0-2)"));
+  TEST_ASSERT_EQUAL_INT32(-ONE, eval("min(0-1, 5)"));
+  TEST_ASSERT_EQUAL_INT32(5 * ONE, eval("max(0-1, 5)"));
+}
+
+void test_constants_fold_to_one_load() {
+  eval("(2+3)*4 - sin(1)/2");
+  TEST_ASSERT_EQUAL_INT(6, program.length);           // CONST + 4 bytes + END
+  TEST_ASSERT_EQUAL_INT(EXPR_CONST, program.code[0]);
+}
+
+void test_variables() {
+  ExprInputs in = inputs(1.5, 8, 200);
+  TEST_ASSERT_EQUAL_INT32(14 * ONE, eval("i*2+n", 3, in));
+  TEST_ASSERT_EQUAL_INT32(3 * ONE, eval("t*2", 0, in));
+  TEST_ASSERT_EQUAL_INT32(100 * ONE, eval("I/2", 0, in));
+}
+
+// A folded subexpression must give exactly what the interpreter computes
+void test_folding_matches_interpreter() {
+  static const char* const pairs[][2] = {
+    {"sin(i*0.8) + i%3 - min(i,2)/4", "sin(3*0.8) + 3%3 - min(3,2)/4"},
+    {"cos(i*i) * 7 / (i-1)", "cos(3*3) * 7 / (3-1)"},
+    {"frac(i/7) + floor(i*1.3) - abs(1-i)", "frac(3/7) + floor(3*1.3) - abs(1-3)"},
+    {"i/(i-3) + i%(i-3)", "3/(3-3) + 3%(3-3)"},
+    {"i + 20000 + 20000 - i", "3 + 20000 + 20000 - 3"},
+  };
+  for (const auto& pair : pairs) {
+    int32_t computed = eval(pair[0], 3);
+    int32_t folded = eval(pair[1]);
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(folded, computed, pair[0]);
+  }
+}
+
+// ==================== FIXED-POINT MATH ====================
+void test_sine_accuracy() {
+  ExprInputs in = inputs(0, 8, 255);
+  for (double x = -20; x <= 20; x += 0.037) {
+    in.t = (int32_t)lround(x * ONE);
+    double s = eval("sin(t)", 0, in) / (double)ONE;
+    double c = eval("cos(t)", 0, in) / (double)ONE;
+    TEST_ASSERT_TRUE_MESSAGE(fabs(s - sin(x)) < 0.002, "sin");
+    TEST_ASSERT_TRUE_MESSAGE(fabs(c - cos(x)) < 0.002, "cos");
+  }
+}
+
+void test_division_guards() {
+  TEST_ASSERT_EQUAL_INT32(0, eval("5/0"));
+  TEST_ASSERT_EQUAL_INT32(0, eval("5%0"));
+  TEST_ASSERT_EQUAL_INT32(0, eval("i/(i-2)", 2));
+  TEST_ASSERT_EQUAL_INT32(0, eval("i%(i-2)", 2));
+
+  // INT_MIN % -1 raw, folded and at run time
+  TEST_ASSERT_EQUAL_INT32(0, eval("(0-32767-1)%((0-1)/256/256)"));
+  TEST_ASSERT_EQUAL_INT32(0, eval("(i*0-32767-1)%((i*0-1)/256/256)", 1));
+}
+
+// Results past +-32768 pin to the Q16.16 limits, folded and at run time
+void test_overflow_saturates() {
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("20000+20000"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("i+20000+20000"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, eval("0-20000-20000"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, eval("i-20000-20000"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("-(0-32767-1)"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("-(i-32767-1)"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("abs(i-32767-1)"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, eval("(i+300)*(0-300)"));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, eval("(i+1)/(1/256/256)"));
+
+  // A huge sum drives the motors full on rather than wrapping negative
+  eval("i+20000+20000");
+  MotorFrame frame;
+  renderExpression(program, inputs(0, NUM_MOTORS, 255), frame);
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    TEST_ASSERT_EQUAL_UINT8(255, frame.values[i]);
+  }
+}
+
+void test_long_session_t_stays_in_range() {
+  // t restarts every EXPR_T_PERIOD_S; t*8 at the end of a period still fits
+  ExprInputs in = inputs(EXPR_T_PERIOD_S - 0.01, 8, 255);
+  int32_t value = eval("t*8", 0, in);
+  TEST_ASSERT_GREATER_THAN(0, value);
+  TEST_ASSERT_INT32_WITHIN(ONE, (int32_t)((EXPR_T_PERIOD_S * 8) << 16), value);
+}
+
+// ==================== ERRORS AND LIMITS ====================
+void test_syntax_errors() {
+  int errorPos = 0;
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("2+", errorPos));
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("sin(t", errorPos));
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("foo", errorPos));
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("99999", errorPos));
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("min(1)", errorPos));
+
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("1 2", errorPos));
+  TEST_ASSERT_EQUAL_INT(2, errorPos);
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileError("i + T", errorPos));
+  TEST_ASSERT_EQUAL_INT(4, errorPos);
+}
+
+void test_limits() {
+  int errorPos = 0;
+
+  // Ten values live at once
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_STACK,
+                        compileError("i+(i+(i+(i+(i+(i+(i+(i+(i+i))))))))", errorPos));
+
+  char longProgram[EXPR_MAX_SOURCE + 1] = "i";
+  for (int k = 0; k < 50; k++) {
+    strcat(longProgram, "+i");
+  }
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_TOO_LONG, compileError(longProgram, errorPos));
+
+  char longSource[EXPR_MAX_SOURCE + 2];
+  memset(longSource, ' ', sizeof(longSource) - 1);
+  longSource[0] = '1';
+  longSource[sizeof(longSource) - 1] = '\0';
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_TOO_LONG, compileError(longSource, errorPos));
+
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_TOO_LONG, compileError("((((((((((((((((((1))))))))))))))))))", errorPos));
+}
+
+void test_failed_compile_keeps_program() {
+  eval("42");
+  int errorPos = 0;
+  TEST_ASSERT_EQUAL_INT(EXPR_ERR_SYNTAX, compileExpression("42+", program, errorPos));
+  TEST_ASSERT_EQUAL_INT32(42 * ONE, evaluateExpression(program, inputs(0, 8, 255), 0));
+}
+
+// ==================== RENDER ====================
+void test_render_clamps() {
+  eval("i*100 - 50");
+  MotorFrame frame;
+  renderExpression(program, inputs(0, NUM_MOTORS, 255), frame);
+  for (int i = 0; i < NUM_MOTORS; i++) {
+    int expected = i * 100 - 50;
+    TEST_ASSERT_EQUAL_UINT8(expected < 0 ? 0 : (expected > 255 ? 255 : expected), frame.values[i]);
+  }
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_arithmetic_and_precedence);
+  RUN_TEST(test_constants_fold_to_one_load);
+  RUN_TEST(test_variables);
+  RUN_TEST(test_folding_matches_interpreter);
+  RUN_TEST(test_sine_accuracy);
+  RUN_TEST(test_division_guards);
+  RUN_TEST(test_overflow_saturates);
+  RUN_TEST(test_long_session_t_stays_in_range);
+  RUN_TEST(test_syntax_errors);
+  RUN_TEST(test_limits);
+  RUN_TEST(test_failed_compile_keeps_program);
+  RUN_TEST(test_render_clamps);
+  return UNITY_END();
+}
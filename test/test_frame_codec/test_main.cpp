@@ -0,0 +1,222 @@
+/*
+ * Smart Sheet - Frame codec tests
+ * Builds LZSS bit streams by hand (and with a small greedy encoder that
+ * follows tools/pack_library.py) and checks the incremental decoder
+ * rebuilds the frames: overlapping copies, copies that run across frame
+ * boundaries, window wrap-around and truncated input.
+ */
+
+#include <unity.h>
+#include <vector>
+#include "frame_codec.h"
+
+// ==================== BIT WRITER ====================
+struct BitWriter {
+  std::vector<uint8_t> bytes;
+  int used = 8;                      // Bits filled in the last byte
+
+  void put(uint32_t value, int count) {
+    for (int b = count - 1; b >= 0; b--) {
+      if (used == 8) {
+        bytes.push_back(0);
+        used = 0;
+      }
+      if ((value >> b) & 1) {
+        bytes.back() |= 0x80 >> used;
+      }
+      used++;
+    }
+  }
+
+  void literal(uint8_t value) {
+    put(1, 1);
+    put(value, 8);
+  }
+
+  void copy(int distance, int length) {
+    put(0, 1);
+    put(distance - 1, LZ_WINDOW_BITS);
+    put(length - LZ_MIN_MATCH, LZ_LENGTH_BITS);
+  }
+};
+
+// Greedy longest match over the last LZ_WINDOW_SIZE bytes
+static BitWriter encode(const std::vector<uint8_t>& data) {
+  const int maxMatch = LZ_MIN_MATCH + (1 << LZ_LENGTH_BITS) - 1;
+  BitWriter out;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    int bestLength = 0;
+    int bestDistance = 0;
+    for (int distance = 1; distance <= LZ_WINDOW_SIZE && distance <= (int)pos; distance++) {
+      int length = 0;
+      while (length < maxMatch && pos + length < data.size() &&
+             data[pos + length] == data[pos + length - distance]) {
+        length++;
+      }
+      if (length > bestLength) {
+        bestLength = length;
+        bestDistance = distance;
+      }
+    }
+    if (bestLength >= LZ_MIN_MATCH) {
+      out.copy(bestDistance, bestLength);
+      pos += bestLength;
+    }
+    else {
+      out.literal(data[pos++]);
+    }
+  }
+  return out;
+}
+
+// Per-motor deltas against the previous frame, the first against zeros
+static std::vector<uint8_t> deltas(const std::vector<std::vector<uint8_t>>& frames) {
+  std::vector<uint8_t> out;
+  std::vector<uint8_t> previous(frames[0].size(), 0);
+  for (const auto& frame : frames) {
+    for (size_t i = 0; i < frame.size(); i++) {
+      out.push_back(frame[i] - previous[i]);
+    }
+    previous = frame;
+  }
+  return out;
+}
+
+static FrameDecoder decoder;
+
+void setUp() {}
+void tearDown() {}
+
+// ==================== TESTS ====================
+void test_literal_frames() {
+  BitWriter stream;
+  uint8_t input[] = {10, 20, 30, 5, 0, 251};  // Second frame: +5, +0, -5
+  for (uint8_t value : input) {
+    stream.literal(value);
+  }
+
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size());
+  uint8_t row[3] = {0, 0, 0};
+  TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, 3));
+  uint8_t first[] = {10, 20, 30};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(first, row, 3);
+  TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, 3));
+  uint8_t second[] = {15, 20, 25};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(second, row, 3);
+  TEST_ASSERT_FALSE(decodeFrameRow(decoder, row, 3));
+}
+
+void test_overlapping_copy_is_a_run() {
+  BitWriter stream;
+  stream.literal(7);
+  stream.copy(1, 11);                // Repeats the byte just written
+
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size());
+  uint8_t row[12] = {0};
+  TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, 12));
+  for (int i = 0; i < 12; i++) {
+    TEST_ASSERT_EQUAL_UINT8(7, row[i]);
+  }
+}
+
+void test_copy_spans_frames() {
+  // One 17-byte copy feeds the tail of frame 1 and all of frames 2-4
+  BitWriter stream;
+  stream.literal(1);
+  stream.literal(2);
+  stream.literal(3);
+  stream.literal(4);
+  stream.copy(4, 16);
+
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size());
+  uint8_t row[5] = {0};
+  uint8_t expected[5] = {0};
+  const uint8_t pattern[] = {1, 2, 3, 4};
+  for (int frame = 0; frame < 4; frame++) {
+    TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, 5));
+    for (int i = 0; i < 5; i++) {
+      expected[i] += pattern[(frame * 5 + i) % 4];
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, row, 5);
+  }
+  TEST_ASSERT_FALSE(decodeFrameRow(decoder, row, 5));
+}
+
+void test_window_wraps() {
+  // 300 distinct-ish literals, then a copy reaching the full window back
+  BitWriter stream;
+  std::vector<uint8_t> data;
+  for (int i = 0; i < 300; i++) {
+    data.push_back(i * 7 + 3);
+    stream.literal(data.back());
+  }
+  stream.copy(LZ_WINDOW_SIZE, 4);
+  for (int i = 0; i < 4; i++) {
+    data.push_back(data[data.size() - LZ_WINDOW_SIZE]);
+  }
+
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size());
+  uint8_t row[1];
+  for (size_t i = 0; i < data.size(); i++) {
+    row[0] = 0;
+    TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, 1));
+    TEST_ASSERT_EQUAL_UINT8(data[i], row[0]);
+  }
+}
+
+void test_truncated_stream_fails() {
+  BitWriter stream;
+  stream.literal(9);
+  stream.literal(9);
+  stream.literal(9);
+
+  // Drop the last byte: the third literal is cut short
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size() - 1);
+  uint8_t row[3] = {0};
+  TEST_ASSERT_FALSE(decodeFrameRow(decoder, row, 3));
+
+  // A copy token missing its length field
+  BitWriter cut;
+  cut.literal(1);
+  cut.put(0, 1);
+  cut.put(0, LZ_WINDOW_BITS);
+  beginFrameDecode(decoder, cut.bytes.data(), cut.bytes.size() - 1);
+  uint8_t one[2] = {0};
+  TEST_ASSERT_FALSE(decodeFrameRow(decoder, one, 2));
+}
+
+void test_ramps_round_trip() {
+  const int motors = 8;
+  std::vector<std::vector<uint8_t>> frames;
+  for (int f = 0; f < 200; f++) {
+    std::vector<uint8_t> frame(motors);
+    for (int m = 0; m < motors; m++) {
+      int ramp = (f * (m + 1)) % 512;
+      frame[m] = m == 5 ? 128 : (ramp < 256 ? ramp : 511 - ramp);
+    }
+    frames.push_back(frame);
+  }
+  std::vector<uint8_t> data = deltas(frames);
+  BitWriter stream = encode(data);
+  TEST_ASSERT_LESS_THAN(data.size() / 2, stream.bytes.size());
+
+  beginFrameDecode(decoder, stream.bytes.data(), stream.bytes.size());
+  uint8_t row[motors] = {0};
+  for (const auto& frame : frames) {
+    TEST_ASSERT_TRUE(decodeFrameRow(decoder, row, motors));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame.data(), row, motors);
+  }
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_literal_frames);
+  RUN_TEST(test_overlapping_copy_is_a_run);
+  RUN_TEST(test_copy_spans_frames);
+  RUN_TEST(test_window_wraps);
+  RUN_TEST(test_truncated_stream_fails);
+  RUN_TEST(test_ramps_round_trip);
+  return UNITY_END();
+}
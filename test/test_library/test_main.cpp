@@ -0,0 +1,291 @@
+/*
+ * Smart Sheet - Flash library tests
+ * Writes images into the patterns partition the way an upload does and
+ * checks mountLibrary() accepts a well-formed one and rejects every
+ * malformed header, index entry and TRACK record before anything plays.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "library.h"
+#include "motor_bank.h"
+#include "sequencer.h"
+
+// ==================== IMAGE BUILDER ====================
+static Keyframe key(uint32_t timeMs, uint8_t value, Easing easing) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_KEY;
+  k.timeMs = timeMs;
+  k.maskLow = 0xFFFFFFFF;
+  k.value = value;
+  k.easing = easing;
+  return k;
+}
+
+static Keyframe jump(uint32_t timeMs, int target, int repeats) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_JUMP;
+  k.timeMs = timeMs;
+  k.arg = jumpArg(target, repeats);
+  return k;
+}
+
+static Keyframe end(uint32_t timeMs) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_END;
+  k.timeMs = timeMs;
+  return k;
+}
+
+// KEY 0, KEY 100, JUMP 200 -> record 1 twice, END 300
+static std::vector<Keyframe> goodTrack() {
+  return {key(0, 0, EASE_LINEAR), key(100, 200, EASE_OUT), jump(200, 1, 2), end(300)};
+}
+
+// Entry 1 is a 4-motor FRAMES record, entry 2 the given TRACK
+struct Image {
+  LibraryHeader header;
+  std::vector<LibraryEntry> entries;
+  std::vector<std::vector<uint8_t>> records;
+
+  explicit Image(const std::vector<Keyframe>& track = goodTrack()) {
+    memset(&header, 0, sizeof(header));
+    header.magic = LIBRARY_MAGIC;
+    header.version = LIBRARY_VERSION;
+
+    std::vector<uint8_t> frames(3 * 4);
+    for (size_t k = 0; k < frames.size(); k++) {
+      frames[k] = k * 20;
+    }
+    add(1, LIB_FRAMES, 4, 3, frames);
+
+    const uint8_t* bytes = (const uint8_t*)track.data();
+    add(2, LIB_TRACK, 0, track.size(),
+        std::vector<uint8_t>(bytes, bytes + track.size() * sizeof(Keyframe)));
+  }
+
+  void add(uint16_t id, uint8_t kind, uint8_t motors, uint16_t frameCount,
+           const std::vector<uint8_t>& record) {
+    LibraryEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.id = id;
+    entry.kind = kind;
+    entry.motors = motors;
+    entry.frameMs = 20;
+    entry.frameCount = frameCount;
+    entry.length = record.size();
+    entries.push_back(entry);
+    records.push_back(record);
+  }
+
+  // Lays records out 4-byte aligned after the index
+  std::vector<uint8_t> build() {
+    header.count = entries.size();
+    uint32_t at = sizeof(LibraryHeader) + entries.size() * sizeof(LibraryEntry);
+    for (size_t k = 0; k < entries.size(); k++) {
+      at = (at + 3) & ~3u;
+      entries[k].offset = at;
+      at += records[k].size();
+    }
+    header.imageSize = at;
+
+    std::vector<uint8_t> out(at, 0);
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), entries.data(), entries.size() * sizeof(LibraryEntry));
+    for (size_t k = 0; k < entries.size(); k++) {
+      memcpy(out.data() + entries[k].offset, records[k].data(), records[k].size());
+    }
+    return out;
+  }
+};
+
+// Erases the partition and programs the image, as an upload does
+static bool mount(const std::vector<uint8_t>& image) {
+  unmountLibrary();
+  const esp_partition_t* partition = findLibraryPartition();
+  TEST_ASSERT_NOT_NULL(partition);
+  TEST_ASSERT_EQUAL_INT(ESP_OK, esp_partition_erase_range(partition, 0, partition->size));
+  TEST_ASSERT_EQUAL_INT(ESP_OK, esp_partition_write(partition, 0, image.data(), image.size()));
+  bool mounted = mountLibrary();
+  TEST_ASSERT_EQUAL(mounted, isLibraryMounted());
+  return mounted;
+}
+
+static bool mountTrack(const std::vector<Keyframe>& track) {
+  Image image(track);
+  return mount(image.build());
+}
+
+void setUp() {}
+
+void tearDown() {
+  unmountLibrary();
+}
+
+// ==================== WELL-FORMED IMAGE ====================
+void test_good_image_mounts() {
+  Image image;
+  TEST_ASSERT_TRUE(mount(image.build()));
+  TEST_ASSERT_EQUAL_INT(2, getLibraryCount());
+
+  const LibraryEntry* frames = findLibraryEntry(1);
+  TEST_ASSERT_NOT_NULL(frames);
+  TEST_ASSERT_EQUAL_UINT8(LIB_FRAMES, frames->kind);
+  TEST_ASSERT_EQUAL_UINT8(40, libraryRecord(*frames)[2]);
+
+  const LibraryEntry* track = findLibraryEntry(2);
+  TEST_ASSERT_NOT_NULL(track);
+  TEST_ASSERT_EQUAL_UINT8(LIB_TRACK, track->kind);
+  TEST_ASSERT_NULL(findLibraryEntry(3));
+}
+
+void test_erased_partition_does_not_mount() {
+  TEST_ASSERT_FALSE(mount(std::vector<uint8_t>()));
+  TEST_ASSERT_EQUAL_INT(0, getLibraryCount());
+}
+
+// ==================== HEADER AND INDEX ====================
+void test_bad_header_rejected() {
+  Image badMagic;
+  badMagic.header.magic ^= 1;
+  TEST_ASSERT_FALSE(mount(badMagic.build()));
+
+  Image badVersion;
+  badVersion.header.version = LIBRARY_VERSION + 1;
+  TEST_ASSERT_FALSE(mount(badVersion.build()));
+
+  // Larger than the partition it claims to live in
+  Image tooLarge;
+  std::vector<uint8_t> bytes = tooLarge.build();
+  ((LibraryHeader*)bytes.data())->imageSize = findLibraryPartition()->size + 4;
+  TEST_ASSERT_FALSE(mount(bytes));
+
+  // Index runs past the end of the image
+  Image shortImage;
+  bytes = shortImage.build();
+  ((LibraryHeader*)bytes.data())->imageSize = sizeof(LibraryHeader) + sizeof(LibraryEntry);
+  TEST_ASSERT_FALSE(mount(bytes));
+}
+
+void test_bad_entries_rejected() {
+  Image unsorted;
+  unsorted.entries[1].id = 1;
+  TEST_ASSERT_FALSE(mount(unsorted.build()));
+
+  Image pastEnd;
+  std::vector<uint8_t> bytes = pastEnd.build();
+  ((LibraryEntry*)(bytes.data() + sizeof(LibraryHeader)))[0].length += 4096;
+  TEST_ASSERT_FALSE(mount(bytes));
+
+  Image misaligned;
+  bytes = misaligned.build();
+  ((LibraryEntry*)(bytes.data() + sizeof(LibraryHeader)))[0].offset += 2;
+  TEST_ASSERT_FALSE(mount(bytes));
+
+  Image insideIndex;
+  bytes = insideIndex.build();
+  ((LibraryEntry*)(bytes.data() + sizeof(LibraryHeader)))[0].offset = sizeof(LibraryHeader);
+  TEST_ASSERT_FALSE(mount(bytes));
+
+  Image badKind;
+  badKind.entries[0].kind = LIB_FRAMES_LZ + 1;
+  TEST_ASSERT_FALSE(mount(badKind.build()));
+
+  Image empty;
+  empty.entries[0].frameCount = 0;
+  TEST_ASSERT_FALSE(mount(empty.build()));
+}
+
+void test_bad_frames_entries_rejected() {
+  Image noMotors;
+  noMotors.entries[0].motors = 0;
+  TEST_ASSERT_FALSE(mount(noMotors.build()));
+
+  Image noStep;
+  noStep.entries[0].frameMs = 0;
+  TEST_ASSERT_FALSE(mount(noStep.build()));
+
+  Image shortRows;
+  shortRows.entries[0].frameCount = 4;
+  TEST_ASSERT_FALSE(mount(shortRows.build()));
+
+  // Compressed rows wider than the decode buffer
+  Image wideLz;
+  wideLz.entries[0].kind = LIB_FRAMES_LZ;
+  TEST_ASSERT_TRUE(mount(wideLz.build()));
+  wideLz.entries[0].motors = MOTOR_BANK_MAX + 1;
+  TEST_ASSERT_FALSE(mount(wideLz.build()));
+}
+
+// ==================== TRACK RECORDS ====================
+void test_bad_track_records_rejected() {
+  std::vector<Keyframe> track = goodTrack();
+  TEST_ASSERT_TRUE(mountTrack(track));
+
+  track = goodTrack();
+  track[1].op = SEQ_OP_END + 1;
+  TEST_ASSERT_FALSE(mountTrack(track));
+
+  track = goodTrack();
+  track[1].easing = EASING_COUNT;
+  TEST_ASSERT_FALSE(mountTrack(track));
+
+  // Time running backwards
+  track = goodTrack();
+  track[1].timeMs = 250;
+  TEST_ASSERT_FALSE(mountTrack(track));
+
+  // JUMP to itself or forwards
+  track = goodTrack();
+  track[2].arg = jumpArg(2, 2);
+  TEST_ASSERT_FALSE(mountTrack(track));
+  track[2].arg = jumpArg(3, 2);
+  TEST_ASSERT_FALSE(mountTrack(track));
+
+  // JUMP back to a record at the same time loops without time passing
+  track = goodTrack();
+  track[2].timeMs = 100;
+  TEST_ASSERT_FALSE(mountTrack(track));
+}
+
+void test_track_length_must_match() {
+  Image image;
+  image.entries[1].frameCount = 3;
+  TEST_ASSERT_FALSE(mount(image.build()));
+
+  std::vector<Keyframe> tooLong(SEQ_MAX_KEYFRAMES + 1);
+  for (size_t k = 0; k < tooLong.size(); k++) {
+    tooLong[k] = key(k * 10, 0, EASE_STEP);
+  }
+  TEST_ASSERT_FALSE(mountTrack(tooLong));
+}
+
+// A rejected image replaces the mounted one rather than leaving it live
+void test_rejected_image_unmounts() {
+  Image good;
+  TEST_ASSERT_TRUE(mount(good.build()));
+
+  Image bad;
+  bad.header.magic = 0;
+  TEST_ASSERT_FALSE(mount(bad.build()));
+  TEST_ASSERT_EQUAL_INT(0, getLibraryCount());
+  TEST_ASSERT_NULL(findLibraryEntry(1));
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_good_image_mounts);
+  RUN_TEST(test_erased_partition_does_not_mount);
+  RUN_TEST(test_bad_header_rejected);
+  RUN_TEST(test_bad_entries_rejected);
+  RUN_TEST(test_bad_frames_entries_rejected);
+  RUN_TEST(test_bad_track_records_rejected);
+  RUN_TEST(test_track_length_must_match);
+  RUN_TEST(test_rejected_image_unmounts);
+  return UNITY_END();
+}
@@ -0,0 +1,182 @@
+/*
+ * Smart Sheet - PCA9685 driver tests
+ * Runs the driver against CaptureBus and checks the I2C bursts it emits:
+ * the init sequence, dirty-range merging and what happens when the TX
+ * queue is full. Built by [env:native_pca9685] with two chips.
+ */
+
+#include <unity.h>
+#include "benchmark.h"
+#include "drivers/motor_driver.h"
+
+typedef Pca9685Driver<CaptureBus> Driver;
+
+// ==================== HELPERS ====================
+static const uint8_t OFF[] = {0x00, 0x00, 0x00, PCA9685_FULL_BIT};
+static const uint8_t ON[] = {0x00, PCA9685_FULL_BIT, 0x00, 0x00};
+
+static void expectBurst(int index, uint8_t address, const uint8_t* data, int length) {
+  TEST_ASSERT_LESS_THAN(CaptureBus::count, index);
+  const I2cBurst& burst = CaptureBus::bursts[index];
+  TEST_ASSERT_EQUAL_HEX8(address, burst.address);
+  TEST_ASSERT_EQUAL_INT(length, burst.length);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(data, burst.data, length);
+}
+
+static void expectRegister(int index, uint8_t address, uint8_t reg, uint8_t value) {
+  uint8_t data[2] = {reg, value};
+  expectBurst(index, address, data, sizeof(data));
+}
+
+static uint8_t ledRegister(int channel) {
+  return PCA9685_LED0_ON_L + channel * PCA9685_REGS_PER_CHANNEL;
+}
+
+void setUp() {
+  Driver::begin();
+  CaptureBus::clear();
+}
+
+void tearDown() {
+  CaptureBus::full = false;
+}
+
+// ==================== INIT ====================
+void test_begin_sequence() {
+  CaptureBus::begin(0, 0, 0);
+  Driver::begin();
+  TEST_ASSERT_EQUAL_INT(Driver::CHIPS * 6, CaptureBus::count);
+
+  for (int chip = 0; chip < Driver::CHIPS; chip++) {
+    uint8_t address = PCA9685_BASE_ADDRESS + chip;
+    int first = chip * 6;
+    expectRegister(first, address, PCA9685_MODE1, PCA9685_MODE1_SLEEP | PCA9685_MODE1_AI);
+    expectRegister(first + 1, address, PCA9685_PRE_SCALE, 3);  // 25 MHz / (4096 * 1526 Hz) - 1
+    expectRegister(first + 2, address, PCA9685_MODE1, PCA9685_MODE1_AI);
+    expectRegister(first + 3, address, PCA9685_MODE1, PCA9685_MODE1_RESTART | PCA9685_MODE1_AI);
+    expectRegister(first + 4, address, PCA9685_MODE2, PCA9685_MODE2_OUTDRV);
+
+    // All 16 channels off in one auto-increment burst
+    const I2cBurst& block = CaptureBus::bursts[first + 5];
+    TEST_ASSERT_EQUAL_HEX8(address, block.address);
+    TEST_ASSERT_EQUAL_INT(I2C_BURST_MAX, block.length);
+    TEST_ASSERT_EQUAL_HEX8(PCA9685_LED0_ON_L, block.data[0]);
+    for (int ch = 0; ch < PCA9685_CHANNELS; ch++) {
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(OFF, block.data + 1 + ch * PCA9685_REGS_PER_CHANNEL, 4);
+    }
+  }
+}
+
+// ==================== COMMIT ====================
+void test_unchanged_duty_sends_nothing() {
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(0, CaptureBus::count);
+
+  Driver::write(3, 0);               // Already off
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(0, CaptureBus::count);
+}
+
+void test_duty_encoding() {
+  Driver::write(1, 128);
+  Driver::commit();
+
+  // ON staggered to channel << 8, OFF = ON + 128 stretched to 12 bits
+  uint8_t data[] = {ledRegister(1), 0x00, 0x01, 0x08, 0x09};
+  expectBurst(0, PCA9685_BASE_ADDRESS, data, sizeof(data));
+}
+
+void test_full_duty_uses_full_on_bit() {
+  Driver::write(0, PWM_MAX_DUTY);
+  Driver::commit();
+
+  uint8_t data[] = {ledRegister(0), ON[0], ON[1], ON[2], ON[3]};
+  expectBurst(0, PCA9685_BASE_ADDRESS, data, sizeof(data));
+}
+
+void test_short_gap_is_merged() {
+  Driver::write(0, PWM_MAX_DUTY);
+  Driver::write(2, PWM_MAX_DUTY);
+  Driver::commit();
+
+  // Channel 1 is clean but resent rather than starting a second burst
+  TEST_ASSERT_EQUAL_INT(1, CaptureBus::count);
+  uint8_t data[1 + 12];
+  data[0] = ledRegister(0);
+  memcpy(data + 1, ON, 4);
+  memcpy(data + 5, OFF, 4);
+  memcpy(data + 9, ON, 4);
+  expectBurst(0, PCA9685_BASE_ADDRESS, data, sizeof(data));
+}
+
+void test_long_gap_splits() {
+  Driver::write(0, PWM_MAX_DUTY);
+  Driver::write(3, PWM_MAX_DUTY);
+  Driver::commit();
+
+  TEST_ASSERT_EQUAL_INT(2, CaptureBus::count);
+  uint8_t first[] = {ledRegister(0), ON[0], ON[1], ON[2], ON[3]};
+  uint8_t second[] = {ledRegister(3), ON[0], ON[1], ON[2], ON[3]};
+  expectBurst(0, PCA9685_BASE_ADDRESS, first, sizeof(first));
+  expectBurst(1, PCA9685_BASE_ADDRESS, second, sizeof(second));
+
+  // Both ranges are clean now
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(2, CaptureBus::count);
+}
+
+void test_second_chip_address() {
+  Driver::write(PCA9685_CHANNELS + 15, PWM_MAX_DUTY);
+  Driver::commit();
+
+  uint8_t data[] = {ledRegister(15), ON[0], ON[1], ON[2], ON[3]};
+  expectBurst(0, PCA9685_BASE_ADDRESS + 1, data, sizeof(data));
+}
+
+void test_full_queue_keeps_channels_dirty() {
+  Driver::write(5, PWM_MAX_DUTY);
+  Driver::write(PCA9685_CHANNELS, PWM_MAX_DUTY);
+  CaptureBus::full = true;
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(0, CaptureBus::count);
+
+  // Next frame sends both, the latest shadow value included
+  Driver::write(5, 0);
+  CaptureBus::full = false;
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(2, CaptureBus::count);
+  uint8_t first[] = {ledRegister(5), OFF[0], OFF[1], OFF[2], OFF[3]};
+  uint8_t second[] = {ledRegister(0), ON[0], ON[1], ON[2], ON[3]};
+  expectBurst(0, PCA9685_BASE_ADDRESS, first, sizeof(first));
+  expectBurst(1, PCA9685_BASE_ADDRESS + 1, second, sizeof(second));
+}
+
+// ==================== BENCHMARK ====================
+// Every timed frame must reach the bus, and the outputs end where they began
+void test_commit_benchmark_sends_every_frame() {
+  uint8_t duties[NUM_MOTORS] = {0};
+  benchmarkCommit(duties, 3);
+
+  // Each frame rewrites every channel: one burst per chip, plus the restore
+  // after the third (complemented) frame
+  TEST_ASSERT_EQUAL_INT(Driver::CHIPS * 4, CaptureBus::count);
+  CaptureBus::clear();
+  Driver::write(0, 0);
+  Driver::commit();
+  TEST_ASSERT_EQUAL_INT(0, CaptureBus::count);
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_sequence);
+  RUN_TEST(test_unchanged_duty_sends_nothing);
+  RUN_TEST(test_duty_encoding);
+  RUN_TEST(test_full_duty_uses_full_on_bit);
+  RUN_TEST(test_short_gap_is_merged);
+  RUN_TEST(test_long_gap_splits);
+  RUN_TEST(test_second_chip_address);
+  RUN_TEST(test_full_queue_keeps_channels_dirty);
+  RUN_TEST(test_commit_benchmark_sends_every_frame);
+  return UNITY_END();
+}
@@ -0,0 +1,198 @@
+/*
+ * Smart Sheet - Keyframe sequencer tests
+ * Easing curves sampled through real ramps (endpoints, midpoints and
+ * monotonic shape), JUMP loop counts including repeat counts above 255
+ * and nested loops, and the record rules shared with library tracks.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "sequencer.h"
+
+// ==================== HELPERS ====================
+static MotorFrame frame;
+
+static Keyframe key(uint32_t timeMs, uint8_t value, uint32_t rampMs, Easing easing) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_KEY;
+  k.timeMs = timeMs;
+  k.arg = rampMs;
+  k.maskLow = 0xFFFFFFFF;
+  k.maskHigh = 0xFFFFFFFF;
+  k.value = value;
+  k.easing = easing;
+  return k;
+}
+
+static Keyframe jump(uint32_t timeMs, int target, int repeats) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_JUMP;
+  k.timeMs = timeMs;
+  k.arg = jumpArg(target, repeats);
+  return k;
+}
+
+static Keyframe end(uint32_t timeMs) {
+  Keyframe k;
+  memset(&k, 0, sizeof(k));
+  k.op = SEQ_OP_END;
+  k.timeMs = timeMs;
+  return k;
+}
+
+// Channel 0 after ticking to `at`; the tick runs every SEQ_TICK_MS
+static uint8_t sampleAt(unsigned long at) {
+  sequencerTick(at, frame);
+  return frame.values[0];
+}
+
+// Ticks every millisecond from `from` and returns when playback stopped
+static unsigned long stopTime(unsigned long from, unsigned long limit) {
+  for (unsigned long now = from; now < limit; now++) {
+    sequencerTick(now, frame);
+    if (!getSequencerStatus(now).playing) {
+      return now;
+    }
+  }
+  return limit;
+}
+
+// Starts a 0 -> 255 ramp over 1000 ms at t = 1000
+static void startRamp(Easing easing) {
+  clearSequence();
+  TEST_ASSERT_TRUE(addKeyframe(key(0, 0, 0, EASE_LINEAR)));
+  TEST_ASSERT_TRUE(addKeyframe(key(1000, 255, 1000, easing)));
+  TEST_ASSERT_TRUE(startSequence(0));
+}
+
+void setUp() {
+  memset(&frame, 0, sizeof(frame));
+}
+
+void tearDown() {
+  clearSequence();
+}
+
+// ==================== EASING ====================
+void test_easing_midpoints() {
+  static const struct { Easing easing; int mid; } cases[] = {
+    {EASE_LINEAR, 127}, {EASE_IN, 63}, {EASE_OUT, 191}, {EASE_IN_OUT, 127}, {EASE_STEP, 0}
+  };
+  for (const auto& c : cases) {
+    startRamp(c.easing);
+    sampleAt(990);
+    TEST_ASSERT_INT_WITHIN(1, c.mid, sampleAt(1500));
+    TEST_ASSERT_EQUAL_UINT8(255, sampleAt(2000));
+  }
+}
+
+// Every curve starts exactly at the old value (EASE_OUT used to overflow
+// at p = 0 and jump straight to the target) and never runs backwards
+void test_easing_starts_at_from_and_is_monotonic() {
+  for (int easing = 0; easing < EASING_COUNT; easing++) {
+    startRamp((Easing)easing);
+    sampleAt(990);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, sampleAt(1000), "start");
+
+    uint8_t previous = 0;
+    for (unsigned long now = 1010; now <= 2000; now += 10) {
+      uint8_t value = sampleAt(now);
+      TEST_ASSERT_TRUE_MESSAGE(value >= previous, "monotonic");
+      previous = value;
+    }
+    TEST_ASSERT_EQUAL_UINT8(255, previous);
+  }
+}
+
+void test_falling_ramp() {
+  clearSequence();
+  TEST_ASSERT_TRUE(addKeyframe(key(0, 200, 0, EASE_LINEAR)));
+  TEST_ASSERT_TRUE(addKeyframe(key(100, 0, 400, EASE_OUT)));
+  TEST_ASSERT_TRUE(startSequence(0));
+
+  TEST_ASSERT_EQUAL_UINT8(200, sampleAt(100));
+  TEST_ASSERT_INT_WITHIN(1, 50, sampleAt(300));   // 200 * (1 - 0.75)
+  TEST_ASSERT_EQUAL_UINT8(0, sampleAt(500));
+}
+
+// ==================== JUMP ====================
+// KEY 0, KEY 100, JUMP 200 -> record 1, END 300: each pass adds 100 ms
+static unsigned long loopEnd(int repeats) {
+  clearSequence();
+  TEST_ASSERT_TRUE(addKeyframe(key(0, 10, 0, EASE_STEP)));
+  TEST_ASSERT_TRUE(addKeyframe(key(100, 200, 0, EASE_STEP)));
+  TEST_ASSERT_TRUE(addKeyframe(jump(200, 1, repeats)));
+  TEST_ASSERT_TRUE(addKeyframe(end(300)));
+  TEST_ASSERT_TRUE(startSequence(0));
+  return stopTime(0, 100000);
+}
+
+void test_jump_repeats() {
+  TEST_ASSERT_EQUAL_UINT32(100000, loopEnd(0));      // Zero repeats never ends
+  TEST_ASSERT_UINT32_WITHIN(10, 300 + 1 * 100, loopEnd(1));
+  TEST_ASSERT_UINT32_WITHIN(10, 300 + 3 * 100, loopEnd(3));
+}
+
+// Counts above 255 used to wrap an 8-bit counter and loop forever
+void test_jump_repeats_beyond_255() {
+  TEST_ASSERT_UINT32_WITHIN(10, 300 + 300 * 100, loopEnd(300));
+}
+
+// Inner loop counts restart on every pass of the outer loop
+void test_nested_loops() {
+  clearSequence();
+  TEST_ASSERT_TRUE(addKeyframe(key(0, 10, 0, EASE_STEP)));
+  TEST_ASSERT_TRUE(addKeyframe(key(100, 200, 0, EASE_STEP)));
+  TEST_ASSERT_TRUE(addKeyframe(jump(200, 1, 2)));   // +2 x 100 ms per pass
+  TEST_ASSERT_TRUE(addKeyframe(jump(300, 0, 2)));   // 3 passes of 500 ms
+  TEST_ASSERT_TRUE(addKeyframe(end(400)));
+  TEST_ASSERT_TRUE(startSequence(0));
+
+  TEST_ASSERT_UINT32_WITHIN(10, 3 * 500 + 100, stopTime(0, 100000));
+}
+
+// ==================== RECORD RULES ====================
+void test_record_rules() {
+  Keyframe track[2] = {key(0, 0, 0, EASE_LINEAR), key(100, 10, 0, EASE_LINEAR)};
+
+  TEST_ASSERT_TRUE(validKeyframe(key(100, 0, 0, EASE_STEP), track, 2));
+  TEST_ASSERT_FALSE(validKeyframe(key(99, 0, 0, EASE_LINEAR), track, 2));
+
+  Keyframe badEasing = key(200, 0, 0, EASE_LINEAR);
+  badEasing.easing = EASING_COUNT;
+  TEST_ASSERT_FALSE(validKeyframe(badEasing, track, 2));
+
+  Keyframe badOp = end(200);
+  badOp.op = SEQ_OP_END + 1;
+  TEST_ASSERT_FALSE(validKeyframe(badOp, track, 2));
+
+  TEST_ASSERT_TRUE(validKeyframe(jump(200, 1, 0), track, 2));
+  TEST_ASSERT_FALSE(validKeyframe(jump(200, 2, 0), track, 2));   // Not an earlier record
+  TEST_ASSERT_FALSE(validKeyframe(jump(100, 1, 0), track, 2));   // Would loop without time passing
+  TEST_ASSERT_FALSE(validKeyframe(jump(0, 0, 0), track, 0));
+}
+
+void test_rejected_record_not_added() {
+  clearSequence();
+  TEST_ASSERT_TRUE(addKeyframe(key(100, 0, 0, EASE_LINEAR)));
+  TEST_ASSERT_FALSE(addKeyframe(key(50, 0, 0, EASE_LINEAR)));
+  TEST_ASSERT_FALSE(addKeyframe(jump(100, 0, 0)));
+  TEST_ASSERT_TRUE(startSequence(0));
+  TEST_ASSERT_EQUAL_INT(1, getSequencerStatus(0).keyCount);
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_easing_midpoints);
+  RUN_TEST(test_easing_starts_at_from_and_is_monotonic);
+  RUN_TEST(test_falling_ramp);
+  RUN_TEST(test_jump_repeats);
+  RUN_TEST(test_jump_repeats_beyond_255);
+  RUN_TEST(test_nested_loops);
+  RUN_TEST(test_record_rules);
+  RUN_TEST(test_rejected_record_not_added);
+  return UNITY_END();
+}
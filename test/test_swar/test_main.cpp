@@ -0,0 +1,164 @@
+/*
+ * Smart Sheet - SWAR byte-lane tests
+ * Checks every packed operation lane by lane against the plain per-byte
+ * arithmetic it replaces, over all operand pairs, with the neighbouring
+ * lanes busy so a carry or borrow leaking across a lane shows up.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "mixer.h"
+
+// ==================== HELPERS ====================
+static inline uint8_t lane(uint32_t word, int l) {
+  return (word >> (l * 8)) & 0xFF;
+}
+
+// Lane 0 holds the pair under test; the others hold related values that
+// put carries and borrows next to it
+static uint32_t packA(int a, int b) {
+  return a | (b << 8) | ((255 - a) << 16) | ((a ^ 0x55) << 24);
+}
+
+static uint32_t packB(int a, int b) {
+  return b | (a << 8) | ((255 - b) << 16) | ((b ^ 0xAA) << 24);
+}
+
+typedef uint32_t (*PairOp)(uint32_t, uint32_t);
+typedef int (*PairRef)(int, int);
+
+static void checkPairs(PairOp op, PairRef ref) {
+  for (int a = 0; a < 256; a++) {
+    for (int b = 0; b < 256; b++) {
+      uint32_t x = packA(a, b);
+      uint32_t y = packB(a, b);
+      uint32_t out = op(x, y);
+      for (int l = 0; l < 4; l++) {
+        if (lane(out, l) != ref(lane(x, l), lane(y, l))) {
+          char message[64];
+          snprintf(message, sizeof(message), "a=%d b=%d lane %d", a, b, l);
+          TEST_ASSERT_EQUAL_UINT8_MESSAGE(ref(lane(x, l), lane(y, l)), lane(out, l), message);
+        }
+      }
+    }
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ==================== LANE ARITHMETIC ====================
+void test_add_saturates() {
+  checkPairs(swarAddSat, [](int a, int b) { return a + b > 255 ? 255 : a + b; });
+}
+
+void test_sub_clamps_at_zero() {
+  checkPairs(swarSubSat, [](int a, int b) { return a > b ? a - b : 0; });
+}
+
+void test_max() {
+  checkPairs(swarMax, [](int a, int b) { return a > b ? a : b; });
+}
+
+void test_multiply() {
+  checkPairs(swarMultiply, [](int a, int b) { return a * (b + 1) >> 8; });
+
+  // Full scale on either side is exact
+  TEST_ASSERT_EQUAL_HEX32(0x12345678, swarMultiply(0x12345678, 0xFFFFFFFF));
+  TEST_ASSERT_EQUAL_HEX32(0, swarMultiply(0x12345678, 0));
+}
+
+void test_scale_all_factors() {
+  for (uint32_t s = 0; s <= 256; s++) {
+    for (int x = 0; x < 256; x++) {
+      uint32_t word = packA(x, 255 - x);
+      uint32_t out = swarScale(word, s);
+      for (int l = 0; l < 4; l++) {
+        TEST_ASSERT_EQUAL_UINT8(lane(word, l) * s >> 8, lane(out, l));
+      }
+    }
+  }
+}
+
+void test_lerp_endpoints_and_midpoint() {
+  for (int a = 0; a < 256; a += 5) {
+    for (int b = 0; b < 256; b += 3) {
+      uint32_t x = packA(a, b);
+      uint32_t y = packB(a, b);
+      TEST_ASSERT_EQUAL_HEX32(x, swarLerp(x, y, 0));
+      TEST_ASSERT_EQUAL_HEX32(y, swarLerp(x, y, 256));
+
+      uint32_t mid = swarLerp(x, y, 128);
+      for (int l = 0; l < 4; l++) {
+        TEST_ASSERT_EQUAL_UINT8((lane(x, l) >> 1) + (lane(y, l) >> 1), lane(mid, l));
+      }
+    }
+  }
+}
+
+void test_opacity_scale() {
+  TEST_ASSERT_EQUAL_UINT32(0, swarOpacity(0));
+  TEST_ASSERT_EQUAL_UINT32(127, swarOpacity(127));
+  TEST_ASSERT_EQUAL_UINT32(129, swarOpacity(128));
+  TEST_ASSERT_EQUAL_UINT32(256, swarOpacity(255));
+}
+
+// ==================== FRAME BLENDING ====================
+void test_blend_modes_at_full_opacity() {
+  MotorFrame base, layer, out;
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    base.values[i] = i * 37 % 256;
+    layer.values[i] = 255 - i * 53 % 256;
+  }
+
+  out = base;
+  blendFrame(out, layer, BLEND_ADD, 255);
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    TEST_ASSERT_EQUAL_UINT8(min(base.values[i] + layer.values[i], 255), out.values[i]);
+  }
+
+  out = base;
+  blendFrame(out, layer, BLEND_MAX, 255);
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    TEST_ASSERT_EQUAL_UINT8(max(base.values[i], layer.values[i]), out.values[i]);
+  }
+
+  out = base;
+  blendFrame(out, layer, BLEND_MULTIPLY, 255);
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    TEST_ASSERT_EQUAL_UINT8(base.values[i] * (layer.values[i] + 1) >> 8, out.values[i]);
+  }
+
+  out = base;
+  blendFrame(out, layer, BLEND_CROSSFADE, 255);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(layer.values, out.values, sizeof(out.values));
+}
+
+void test_zero_opacity_leaves_base() {
+  MotorFrame base, layer;
+  for (int i = 0; i < FRAME_WORDS * 4; i++) {
+    base.values[i] = 200 - i;
+    layer.values[i] = 255;
+  }
+
+  for (int mode = BLEND_ADD; mode <= BLEND_CROSSFADE; mode++) {
+    MotorFrame out = base;
+    blendFrame(out, layer, (BlendMode)mode, 0);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(base.values, out.values, sizeof(out.values));
+  }
+}
+
+// ==================== ENTRY POINT ====================
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_add_saturates);
+  RUN_TEST(test_sub_clamps_at_zero);
+  RUN_TEST(test_max);
+  RUN_TEST(test_multiply);
+  RUN_TEST(test_scale_all_factors);
+  RUN_TEST(test_lerp_endpoints_and_midpoint);
+  RUN_TEST(test_opacity_scale);
+  RUN_TEST(test_blend_modes_at_full_opacity);
+  RUN_TEST(test_zero_opacity_leaves_base);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Benchmark comparison
+
+Compares two BENCH:JSON results (one saved before a change, one after)
+and reports every metric that moved by more than the threshold. Inputs
+may be bare JSON or any log containing a "BENCH:JSON:" line, such as a
+native run:
+
+    echo BENCH:JSON | .pio/build/native/program 2>/dev/null > after.txt
+    tools/bench_compare.py before.txt after.txt --threshold 10
+
+Cycle figures are lower-is-better; commandsPerSec and streamKBs are
+higher-is-better. Exits with status 1 if anything regressed.
+"""
+
+import argparse
+import json
+import sys
+
+PREFIX = "BENCH:JSON:"
+HIGHER_IS_BETTER = ("commandsPerSec", "streamKBs")
+
+
+def fail(message):
+    sys.exit("error: " + message)
+
+
+def load(path):
+    with open(path) as f:
+        text = f.read()
+    for line in text.splitlines():
+        if line.startswith(PREFIX):
+            return json.loads(line[len(PREFIX):])
+    try:
+        return json.loads(text)
+    except ValueError:
+        fail("%s: no BENCH:JSON result" % path)
+
+
+def flatten(result, prefix=""):
+    metrics = {}
+    for key, value in result.items():
+        name = prefix + key
+        if isinstance(value, dict):
+            metrics.update(flatten(value, name + "."))
+        elif isinstance(value, (int, float)) and key != "cyclesPerUs":
+            metrics[name] = value
+    return metrics
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two Smart Sheet benchmark runs")
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent change to report (default 5)")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    for key in ("driver", "cyclesPerUs"):
+        if before.get(key) != after.get(key):
+            fail("runs differ in %s (%s vs %s), figures are not comparable" %
+                 (key, before.get(key), after.get(key)))
+
+    old = flatten(before)
+    new = flatten(after)
+    regressions = 0
+    for name in sorted(set(old) & set(new)):
+        if old[name] == 0:
+            continue
+        change = 100.0 * (new[name] - old[name]) / old[name]
+        if abs(change) < args.threshold:
+            continue
+        worse = change < 0 if name.endswith(HIGHER_IS_BETTER) else change > 0
+        regressions += worse
+        print("%-28s %10d -> %10d  %+7.1f%%  %s" %
+              (name, old[name], new[name], change, "REGRESSION" if worse else "improved"))
+
+    for name in sorted(set(old) ^ set(new)):
+        print("%-28s only in %s" % (name, "before" if name in old else "after"))
+
+    print("%d regression(s) over %.1f%%" % (regressions, args.threshold))
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Golden trace regression test
+
+Replays every command script in test/golden/*.txt through the firmware
+simulator and compares the duty traces it writes with the checked-in
+<name>.csv and <name>.vcd next to the script. A scripted run is
+deterministic, so any difference means the output changed:
+
+    pio run -e native_sim
+    tools/golden_traces.py
+    tools/golden_traces.py --update wave      # accept a new wave.csv/.vcd
+
+Changes that are meant to be output-equivalent (fixed-point math, caches,
+new commit paths) must pass unchanged. Exits with status 1 on any
+mismatch or missing golden file.
+"""
+
+import argparse
+import difflib
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+DEFAULT_SIM = ".pio/build/native_sim/program"
+DEFAULT_DIR = "test/golden"
+TRACES = (".csv", ".vcd")
+DIFF_LINES = 12
+
+
+def fail(message):
+    sys.exit("error: " + message)
+
+
+def run(sim, script, workdir):
+    name = os.path.splitext(os.path.basename(script))[0]
+    out = {ext: os.path.join(workdir, name + ext) for ext in TRACES}
+    env = dict(os.environ)
+    env.pop("SMARTSHEET_LIBRARY", None)   # Empty flash, as on a fresh board
+    result = subprocess.run(
+        [sim, "--script", script, "--csv", out[".csv"], "--vcd", out[".vcd"],
+         "--link", os.path.join(workdir, name + ".pty"), "--speed", "0"],
+        stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, env=env, text=True)
+    if result.returncode != 0:
+        fail("%s: simulator exited with %d\n%s" % (script, result.returncode, result.stderr))
+    return out
+
+
+def compare(golden, actual):
+    with open(golden) as f:
+        expected = f.read().splitlines()
+    with open(actual) as f:
+        got = f.read().splitlines()
+    if expected == got:
+        return None
+    diff = difflib.unified_diff(expected, got, golden, "simulated", lineterm="", n=1)
+    return "\n".join(line for _, line in zip(range(DIFF_LINES), diff))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check simulator traces against golden files")
+    parser.add_argument("names", nargs="*", help="scripts to run (default: all)")
+    parser.add_argument("--sim", default=DEFAULT_SIM,
+                        help="simulator binary (default %s)" % DEFAULT_SIM)
+    parser.add_argument("--dir", default=DEFAULT_DIR,
+                        help="scripts and golden traces (default %s)" % DEFAULT_DIR)
+    parser.add_argument("--update", action="store_true",
+                        help="overwrite the golden traces with this run's output")
+    args = parser.parse_args()
+
+    if not os.access(args.sim, os.X_OK):
+        fail("%s: no simulator binary (pio run -e native_sim)" % args.sim)
+    if args.names:
+        scripts = [os.path.join(args.dir, name + ".txt") for name in args.names]
+    else:
+        scripts = sorted(glob.glob(os.path.join(args.dir, "*.txt")))
+    if not scripts:
+        fail("%s: no scripts" % args.dir)
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        for script in scripts:
+            if not os.path.exists(script):
+                fail("%s: no such script" % script)
+            out = run(os.path.abspath(args.sim), script, workdir)
+            base = os.path.splitext(script)[0]
+            problems = []
+            for ext in TRACES:
+                golden = base + ext
+                if args.update:
+                    shutil.copyfile(out[ext], golden)
+                elif not os.path.exists(golden):
+                    problems.append("%s: missing (run with --update)" % golden)
+                else:
+                    diff = compare(golden, out[ext])
+                    if diff:
+                        problems.append(diff)
+
+            name = os.path.basename(base)
+            if args.update:
+                print("UPDATED %s" % name)
+            elif problems:
+                failures += 1
+                print("FAIL    %s" % name)
+                for problem in problems:
+                    print(problem)
+            else:
+                print("PASS    %s" % name)
+
+    if failures:
+        print("%d of %d traces differ" % (failures, len(scripts)))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Pattern library packer
+
+Builds the image for the "patterns" flash partition (see src/library.h)
+from a JSON description:
+
+    {
+      "patterns": [
+        {"id": 1, "frame_ms": 20, "loop": true,
+         "frames": [[0, 64, 128, 255, 128, 64, 0, 0], ...]},
+        {"id": 2, "frame_ms": 50, "frames_csv": "ripple.csv"},
+        {"id": 3, "track": [
+          {"time": 0,    "op": "KEY",  "mask": "FF", "value": 200, "ramp": 500, "easing": "INOUT"},
+          {"time": 1000, "op": "KEY",  "mask": "FF", "value": 0,   "ramp": 500},
+          {"time": 1500, "op": "JUMP", "target": 0, "repeats": 0}
+        ]}
+      ]
+    }
+
+FRAMES records hold one row of 0-255 intensities per step; CSV files have
+one row per line. Add "compress": true (or pass --compress) to store them
+delta- and LZSS-encoded instead (src/frame_codec.h). TRACK records hold
+sequencer keyframes (same fields as the SEQ: commands) and play in place
+through the sequencer.
+
+Usage:
+    tools/pack_library.py library.json -o library.bin [--compress]
+    esptool.py --chip esp32 write_flash 0x3D0000 library.bin
+"""
+
+import argparse
+import csv
+import json
+import os
+import struct
+import sys
+
+LIBRARY_MAGIC = 0x4C505353         # "SSPL"
+LIBRARY_VERSION = 1
+PARTITION_SIZE = 0x30000           # partitions.csv
+
+KIND_FRAMES = 0
+KIND_TRACK = 1
+KIND_FRAMES_LZ = 2
+FLAG_LOOP = 0x01
+MOTOR_BANK_MAX = 64
+
+# src/frame_codec.h
+LZ_WINDOW_BITS = 8
+LZ_LENGTH_BITS = 4
+LZ_MIN_MATCH = 2
+LZ_MAX_MATCH = LZ_MIN_MATCH + (1 << LZ_LENGTH_BITS) - 1
+
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<HBBB3xHHII")
+KEYFRAME = struct.Struct("<IIIIBBBx")
+
+OPS = {"KEY": 0, "JUMP": 1, "END": 2}
+EASINGS = {"LINEAR": 0, "IN": 1, "OUT": 2, "INOUT": 3, "STEP": 4}
+SEQ_MAX_KEYFRAMES = 128
+
+
+def fail(message):
+    sys.exit("pack_library: " + message)
+
+
+def load_frames(pattern, base_dir):
+    if "frames_csv" in pattern:
+        with open(os.path.join(base_dir, pattern["frames_csv"]), newline="") as f:
+            rows = [[int(v) for v in row] for row in csv.reader(f) if row]
+    else:
+        rows = pattern.get("frames", [])
+    if not rows:
+        fail("pattern %d has no frames" % pattern["id"])
+
+    motors = len(rows[0])
+    for row in rows:
+        if len(row) != motors:
+            fail("pattern %d rows differ in length" % pattern["id"])
+        if any(v < 0 or v > 255 for v in row):
+            fail("pattern %d has values outside 0-255" % pattern["id"])
+    if motors > 255 or len(rows) > 0xFFFF:
+        fail("pattern %d is too large" % pattern["id"])
+    return motors, rows
+
+
+class BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.acc = 0
+        self.count = 0
+
+    def write(self, value, bits):
+        for shift in range(bits - 1, -1, -1):
+            self.acc = (self.acc << 1) | ((value >> shift) & 1)
+            self.count += 1
+            if self.count == 8:
+                self.data.append(self.acc)
+                self.acc = 0
+                self.count = 0
+
+    def finish(self):
+        if self.count:
+            self.data.append(self.acc << (8 - self.count))
+        return bytes(self.data)
+
+
+def delta_encode(rows):
+    previous = [0] * len(rows[0])
+    out = bytearray()
+    for row in rows:
+        out.extend((v - p) & 0xFF for v, p in zip(row, previous))
+        previous = row
+    return bytes(out)
+
+
+def lzss_encode(data):
+    """Greedy LZSS matching the decoder in src/frame_codec.cpp. The decoder's
+    window starts zero-filled, so matches may reach back before the start.
+    Candidates come from hash chains on the next two bytes."""
+    window = 1 << LZ_WINDOW_BITS
+    history = bytes(window) + data
+    chains = {}
+    inserted = 0
+    writer = BitWriter()
+    pos = window
+    while pos < len(history):
+        while inserted < pos:
+            chains.setdefault(history[inserted:inserted + 2], []).append(inserted)
+            inserted += 1
+
+        best_length = 0
+        best_distance = 0
+        limit = min(LZ_MAX_MATCH, len(history) - pos)
+        candidates = chains.get(history[pos:pos + 2], [])
+        for start in reversed(candidates):
+            distance = pos - start
+            if distance > window:
+                break
+            length = 0
+            # Overlapping copies repeat the last `distance` bytes
+            while length < limit and history[start + length] == history[pos + length]:
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_distance = distance
+                if length == limit:
+                    break
+
+        if best_length >= LZ_MIN_MATCH:
+            writer.write(0, 1)
+            writer.write(best_distance - 1, LZ_WINDOW_BITS)
+            writer.write(best_length - LZ_MIN_MATCH, LZ_LENGTH_BITS)
+            pos += best_length
+        else:
+            writer.write(1, 1)
+            writer.write(history[pos], 8)
+            pos += 1
+    return writer.finish()
+
+
+def pack_frames(pattern, base_dir, compress):
+    motors, rows = load_frames(pattern, base_dir)
+    frame_ms = int(pattern.get("frame_ms", 20))
+    if not 1 <= frame_ms <= 0xFFFF:
+        fail("pattern %d frame_ms out of range" % pattern["id"])
+    flags = FLAG_LOOP if pattern.get("loop", False) else 0
+
+    if pattern.get("compress", compress):
+        if motors > MOTOR_BANK_MAX:
+            fail("pattern %d has too many motors to compress" % pattern["id"])
+        data = lzss_encode(delta_encode(rows))
+        return motors, KIND_FRAMES_LZ, flags, frame_ms, len(rows), data
+
+    data = bytes(v for row in rows for v in row)
+    return motors, KIND_FRAMES, flags, frame_ms, len(rows), data
+
+
+def pack_track(pattern):
+    keys = pattern["track"]
+    if not 0 < len(keys) <= SEQ_MAX_KEYFRAMES:
+        fail("pattern %d track must have 1-%d keyframes" % (pattern["id"], SEQ_MAX_KEYFRAMES))
+
+    data = b""
+    for key in keys:
+        op = OPS[key["op"].upper()]
+        arg = mask = value = easing = 0
+        if op == OPS["KEY"]:
+            arg = int(key.get("ramp", 0))
+            mask = 0xFFFFFFFFFFFFFFFF if str(key["mask"]).upper() == "ALL" else int(str(key["mask"]), 16)
+            value = int(key["value"])
+            easing = EASINGS[key.get("easing", "LINEAR").upper()]
+        elif op == OPS["JUMP"]:
+            arg = int(key["target"]) | (int(key.get("repeats", 0)) << 16)
+        data += KEYFRAME.pack(int(key["time"]), arg, mask & 0xFFFFFFFF, mask >> 32,
+                              op, value, easing)
+    return 0, KIND_TRACK, 0, 0, len(keys), data
+
+
+def build_image(spec, base_dir, compress=False):
+    patterns = sorted(spec["patterns"], key=lambda p: p["id"])
+    ids = [p["id"] for p in patterns]
+    if len(set(ids)) != len(ids):
+        fail("duplicate pattern ids")
+
+    records = []
+    for pattern in patterns:
+        if "track" in pattern:
+            records.append((pattern["id"],) + pack_track(pattern))
+        else:
+            records.append((pattern["id"],) + pack_frames(pattern, base_dir, compress))
+
+    offset = HEADER.size + ENTRY.size * len(records)
+    index = b""
+    body = b""
+    for pattern_id, motors, kind, flags, frame_ms, count, data in records:
+        pad = -(offset + len(body)) % 4
+        body += b"\xff" * pad
+        index += ENTRY.pack(pattern_id, motors, kind, flags, frame_ms, count,
+                            offset + len(body), len(data))
+        body += data
+
+    size = HEADER.size + len(index) + len(body)
+    return HEADER.pack(LIBRARY_MAGIC, LIBRARY_VERSION, len(records), size, 0) + index + body
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack a Smart Sheet pattern library image")
+    parser.add_argument("spec", help="JSON library description")
+    parser.add_argument("-o", "--output", default="library.bin")
+    parser.add_argument("--partition-size", type=lambda v: int(v, 0), default=PARTITION_SIZE)
+    parser.add_argument("--compress", action="store_true",
+                        help="delta + LZSS encode every FRAMES pattern")
+    args = parser.parse_args()
+
+    with open(args.spec) as f:
+        spec = json.load(f)
+    image = build_image(spec, os.path.dirname(os.path.abspath(args.spec)), args.compress)
+    if len(image) > args.partition_size:
+        fail("image is %d bytes, partition holds %d" % (len(image), args.partition_size))
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("%s: %d patterns, %d bytes (%.1f%% of partition)" %
+          (args.output, len(spec["patterns"]), len(image), 100.0 * len(image) / args.partition_size))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Frame trace dump
+
+Fetches the on-device frame trace with TRACE:DUMP (format in
+src/frame_trace.h), checks its CRC and decodes it into the same
+time_us,motor,duty CSV the simulator writes, with times relative to the
+oldest recorded frame. A summary points at the usual field issues:
+frame interval outliers (stutter), per-motor duty spread (uneven
+motors) and the longest time each motor held a non-zero duty (stuck
+channels).
+
+Usage:
+    tools/trace_dump.py --port /dev/rfcomm0 -o trace.csv --save trace.bin
+    tools/trace_dump.py --input trace.bin -o trace.csv
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+HEADER = "TRACE:DUMP:"
+
+
+def fail(message):
+    sys.exit("error: " + message)
+
+
+# ==================== FETCH ====================
+def parse_header(line):
+    fields = line[len(HEADER):].split(":")
+    if len(fields) != 4:
+        fail("bad dump header: " + line)
+    size, crc, motors, block_size = fields
+    return int(size), int(crc, 16), int(motors), int(block_size)
+
+
+def fetch(port, timeout):
+    port.reset_input_buffer()
+    port.write(b"TRACE:DUMP\n")
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = port.readline().decode("ascii", "replace").strip()
+        if line.startswith(HEADER):
+            header = line
+            break
+    else:
+        fail("no TRACE:DUMP reply")
+
+    size = parse_header(header)[0]
+    data = bytearray()
+    while len(data) < size and time.monotonic() < deadline:
+        data += port.read(size - len(data))
+    if len(data) < size:
+        fail("dump cut short at %d of %d bytes" % (len(data), size))
+    return header, bytes(data)
+
+
+def load(path):
+    with open(path, "rb") as f:
+        raw = f.read()
+    start = raw.find(HEADER.encode("ascii"))
+    end = raw.find(b"\n", start)
+    if start < 0 or end < 0:
+        fail("%s: no TRACE:DUMP header" % path)
+    header = raw[start:end].decode("ascii").strip()
+    size = parse_header(header)[0]
+    return header, raw[end + 1:end + 1 + size]
+
+
+# ==================== DECODE ====================
+def read_varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+def decode(data, motors):
+    """Returns (frame times, [(time_us, motor, duty)]) with device time unwrapped."""
+    mask_bytes = (motors + 7) // 8
+    state = [None] * motors
+    frames = []
+    events = []
+    now = None
+    pos = 0
+    while pos < len(data):
+        used, start = struct.unpack_from("<HI", data, pos)
+        if used < 6 + motors or pos + used > len(data):
+            fail("corrupt block at byte %d" % pos)
+
+        # Block starts are 32-bit micros; carry them past the wrap
+        if now is None:
+            now = start
+        else:
+            now += (start - now) & 0xFFFFFFFF
+        frames.append(now)
+        for m, duty in enumerate(data[pos + 6:pos + 6 + motors]):
+            if state[m] != duty:
+                state[m] = duty
+                events.append((now, m, duty))
+
+        p = pos + 6 + motors
+        while p < pos + used:
+            mask = int.from_bytes(data[p:p + mask_bytes], "little")
+            delta, p = read_varint(data, p + mask_bytes)
+            now += delta
+            frames.append(now)
+            for m in range(motors):
+                if mask >> m & 1:
+                    state[m] = data[p]
+                    events.append((now, m, data[p]))
+                    p += 1
+        pos += used
+    return frames, events
+
+
+# ==================== REPORT ====================
+def summarise(frames, events, motors):
+    origin = frames[0]
+    span = frames[-1] - origin
+    print("%d frames over %.3f s" % (len(frames), span / 1e6))
+
+    intervals = sorted(b - a for a, b in zip(frames, frames[1:]))
+    if intervals:
+        print("frame interval us: p50 %d, p99 %d, max %d" %
+              (intervals[len(intervals) // 2], intervals[int(len(intervals) * 0.99)], intervals[-1]))
+
+    print("%-6s %8s %5s %5s %8s %12s" % ("motor", "changes", "min", "max", "mean", "longest on"))
+    for m in range(motors):
+        mine = [(t, d) for t, mm, d in events if mm == m]
+        weighted = longest = 0
+        for (t, d), (t2, _) in zip(mine, mine[1:] + [(frames[-1], None)]):
+            weighted += d * (t2 - t)
+            if d:
+                longest = max(longest, t2 - t)
+        duties = [d for _, d in mine]
+        print("%-6d %8d %5d %5d %8.1f %10.3f s" %
+              (m + 1, len(mine) - 1, min(duties), max(duties),
+               weighted / span if span else duties[-1], longest / 1e6))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fetch and decode the Smart Sheet frame trace")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="SPP port or simulator PTY")
+    source.add_argument("--input", help="dump saved earlier with --save")
+    parser.add_argument("-o", "--output", help="write time_us,motor,duty CSV")
+    parser.add_argument("--save", help="keep the raw dump")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    if args.port:
+        with serial.Serial(args.port, args.baud, timeout=0.2) as port:
+            header, data = fetch(port, args.timeout)
+    else:
+        header, data = load(args.input)
+
+    size, crc, motors, _ = parse_header(header)
+    if zlib.crc32(data) != crc:
+        fail("CRC mismatch, dump is corrupt")
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(header.encode("ascii") + b"\n" + data)
+    if not data:
+        print("trace is empty")
+        return
+
+    frames, events = decode(data, motors)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write("time_us,motor,duty\n")
+            for t, m, d in events:
+                f.write("%d,%d,%d\n" % (t - frames[0], m + 1, d))
+    summarise(frames, events, motors)
+
+
+if __name__ == "__main__":
+    main()
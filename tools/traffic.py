@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Command traffic recorder, replayer and flood generator
+
+Sessions are text files of "<ms> <command>" lines, the same format the
+simulator takes with --script, so a recorded session can be replayed on
+the device, over the simulator's PTY, or run deterministically in it.
+
+    record   capture commands from the USB console log while the app drives
+             the sheet (the firmware echoes each "BT Received: <command>")
+    replay   send a session at --speed 1, 10, ... or 0 (as fast as possible)
+    flood    send a synthetic mix of slider-drag style commands
+
+replay and flood match each reply to its command and report latency
+percentiles per command, dropped commands (no matching reply), garbled
+ones (the firmware did not recognise them), and the pipeline's worst run
+and overruns over the session (from PIPELINE). With --console on the
+device's USB port, WAVE step intervals are timed as a tick-jitter figure;
+that needs firmware built with -D WAVE_DEBUG, which prints each step.
+
+Usage:
+    tools/traffic.py record --port /dev/ttyUSB0 -o session.txt
+    tools/traffic.py replay session.txt --port /dev/rfcomm0 --speed 10
+    tools/traffic.py flood --port /tmp/smartsheet --count 5000 --rate 0
+"""
+
+import argparse
+import collections
+import random
+import re
+import sys
+import threading
+import time
+
+import serial
+
+REPLY = re.compile(r"^[A-Z][A-Z_]*:")
+RECEIVED = re.compile(r"^(?:BT|Serial|PTY|Stdin) Received: (.*)$")
+WAVE_STEP = "Wave Position:"
+PIPELINE_STATS = re.compile(r"MAX:(\d+).*OVERRUNS:(\d+)")
+UNKNOWN = "ERROR: Unknown command"
+
+# Replies that span several lines or switch the link to binary cannot be
+# matched one-to-one, so sessions skip them
+UNMATCHED = ("BENCH", "PLAY:LIST", "UPLOAD:", "TRACE:DUMP", "HEAP", "STALL:LOG")
+
+
+def fail(message):
+    sys.exit("error: " + message)
+
+
+def read_session(path):
+    session = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            stamp, _, command = line.partition(" ")
+            if not stamp.isdigit() or not command.strip():
+                fail("%s:%d: expected '<ms> <command>'" % (path, number))
+            session.append((int(stamp), command.strip()))
+    return session
+
+
+def write_session(path, session):
+    with open(path, "w") as f:
+        for at, command in session:
+            f.write("%d %s\n" % (at, command))
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100.0))]
+
+
+# ==================== RECORD ====================
+def record(args):
+    port = serial.Serial(args.port, args.baud, timeout=0.1)
+    session = []
+    start = None
+    print("Recording from %s, Ctrl-C to stop" % args.port)
+    try:
+        while True:
+            line = port.readline().decode("ascii", "replace").strip()
+            match = RECEIVED.match(line)
+            if not match:
+                continue
+            now = time.monotonic()
+            start = now if start is None else start
+            session.append((int((now - start) * 1000), match.group(1)))
+            print("%8d %s" % session[-1])
+    except KeyboardInterrupt:
+        pass
+    write_session(args.output, session)
+    print("%s: %d commands" % (args.output, len(session)))
+
+
+# ==================== LINK ====================
+class Link:
+    """Command port with a reader thread collecting timestamped replies."""
+
+    def __init__(self, path, baud):
+        self.port = serial.Serial(path, baud, timeout=0.05)
+        self.replies = collections.deque()
+        self.ready = threading.Condition()
+        self.running = True
+        self.reader = threading.Thread(target=self.read_loop, daemon=True)
+        self.reader.start()
+
+    def read_loop(self):
+        while self.running:
+            line = self.port.readline().decode("ascii", "replace").strip()
+            if REPLY.match(line):
+                with self.ready:
+                    self.replies.append((time.monotonic(), line))
+                    self.ready.notify()
+
+    def send(self, command):
+        self.port.write((command + "\n").encode("ascii"))
+        return time.monotonic()
+
+    def next_reply(self, timeout):
+        with self.ready:
+            if not self.replies:
+                self.ready.wait(timeout)
+            return self.replies.popleft() if self.replies else None
+
+    def query(self, command, prefix, timeout=2.0):
+        self.send(command)
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            reply = self.next_reply(deadline - time.monotonic())
+            if reply and reply[1].startswith(prefix):
+                return reply[1]
+        return None
+
+    def close(self):
+        self.running = False
+        self.reader.join()
+        self.port.close()
+
+
+class ConsoleTicks:
+    """Times WAVE steps from the debug lines on the device's USB console."""
+
+    def __init__(self, path, baud):
+        self.port = serial.Serial(path, baud, timeout=0.05)
+        self.stamps = []
+        self.running = True
+        self.reader = threading.Thread(target=self.read_loop, daemon=True)
+        self.reader.start()
+
+    def read_loop(self):
+        while self.running:
+            line = self.port.readline().decode("ascii", "replace")
+            if line.startswith(WAVE_STEP):
+                self.stamps.append(time.monotonic())
+
+    def close(self):
+        self.running = False
+        self.reader.join()
+        self.port.close()
+        return [(b - a) * 1000 for a, b in zip(self.stamps, self.stamps[1:])]
+
+
+# ==================== MATCHING ====================
+def expects(command, reply):
+    head = command.upper().split(":")[0]
+    head = "PONG" if head == "PING" else head
+    return (reply.startswith("OK:" + head) or reply.startswith(head + ":") or
+            reply.startswith("ERROR"))
+
+
+class Tally:
+    def __init__(self):
+        self.pending = collections.deque()
+        self.latency = collections.defaultdict(list)
+        self.sent = 0
+        self.dropped = 0
+        self.garbled = 0
+        self.errors = 0
+        self.unexpected = 0
+
+    def sent_command(self, command, stamp):
+        self.pending.append((command, stamp))
+        self.sent += 1
+
+    def reply(self, stamp, line):
+        if line.startswith(UNKNOWN):
+            if self.pending:
+                self.pending.popleft()
+            self.garbled += 1
+            return
+        # Commands ahead of the one this reply answers got no reply at all
+        for k, (command, _) in enumerate(self.pending):
+            if expects(command, line):
+                for _ in range(k):
+                    self.pending.popleft()
+                    self.dropped += 1
+                command, sent = self.pending.popleft()
+                self.errors += line.startswith("ERROR")
+                self.latency[command.upper().split(":")[0]].append((stamp - sent) * 1000)
+                return
+        self.unexpected += 1
+
+    def finish(self):
+        self.dropped += len(self.pending)
+        self.pending.clear()
+
+
+def drain(link, tally, window):
+    while len(tally.pending) > window:
+        reply = link.next_reply(0.5)
+        if reply is None:
+            return
+        tally.reply(*reply)
+
+
+def run(link, commands, args):
+    """Send (delay_ms, command) pairs, pacing on the given delays."""
+    console = ConsoleTicks(args.console, args.baud) if args.console else None
+    before = link.query("PIPELINE", "PIPELINE:")
+    tally = Tally()
+    window = args.window if args.window > 0 else float("inf")
+
+    start = time.monotonic()
+    for at, command in commands:
+        due = start + at / 1000.0
+        while time.monotonic() < due:
+            reply = link.next_reply(due - time.monotonic())
+            if reply:
+                tally.reply(*reply)
+        tally.sent_command(command, link.send(command))
+        drain(link, tally, window)
+        while link.replies:
+            tally.reply(*link.next_reply(0))
+
+    deadline = time.monotonic() + args.timeout
+    while tally.pending and time.monotonic() < deadline:
+        reply = link.next_reply(deadline - time.monotonic())
+        if reply:
+            tally.reply(*reply)
+    tally.finish()
+    elapsed = time.monotonic() - start
+
+    after = link.query("PIPELINE", "PIPELINE:")
+    report(tally, elapsed, before, after, console.close() if console else None)
+    return tally
+
+
+def report(tally, elapsed, before, after, intervals):
+    print("%d commands in %.2f s (%.0f/s)" % (tally.sent, elapsed, tally.sent / max(elapsed, 1e-9)))
+    print("dropped %d, garbled %d, error replies %d, unmatched replies %d" %
+          (tally.dropped, tally.garbled, tally.errors, tally.unexpected))
+
+    everything = [v for values in tally.latency.values() for v in values]
+    rows = sorted(tally.latency.items()) + ([("ALL", everything)] if everything else [])
+    print("%-10s %7s %8s %8s %8s %8s" % ("command", "count", "p50 ms", "p90 ms", "p99 ms", "max ms"))
+    for head, values in rows:
+        print("%-10s %7d %8.2f %8.2f %8.2f %8.2f" %
+              (head, len(values), percentile(values, 50), percentile(values, 90),
+               percentile(values, 99), max(values)))
+
+    if before and after:
+        old = PIPELINE_STATS.search(before)
+        new = PIPELINE_STATS.search(after)
+        if old and new:
+            print("pipeline: worst run %s cycles, %d overruns during the session" %
+                  (new.group(1), int(new.group(2)) - int(old.group(2))))
+    else:
+        print("pipeline: no PIPELINE reply")
+
+    if intervals:
+        mean = sum(intervals) / len(intervals)
+        deviation = [abs(v - mean) for v in intervals]
+        print("wave step: %d intervals, mean %.2f ms, jitter p99 %.2f ms, max %.2f ms" %
+              (len(intervals), mean, percentile(deviation, 99), max(deviation)))
+
+
+# ==================== REPLAY ====================
+def replay(args):
+    session = read_session(args.session)
+    kept = [(at, c) for at, c in session if not c.upper().startswith(UNMATCHED)]
+    if len(kept) < len(session):
+        print("skipping %d command(s) with multi-line or binary replies" % (len(session) - len(kept)))
+    scale = 0 if args.speed == 0 else 1.0 / args.speed
+    commands = [(at * scale, command) for at, command in kept]
+
+    link = Link(args.port, args.baud)
+    try:
+        for r in range(args.repeat):
+            if args.repeat > 1:
+                print("-- pass %d" % (r + 1))
+            run(link, commands, args)
+    finally:
+        link.close()
+
+
+# ==================== FLOOD ====================
+def slider(rng):
+    return "INTENSITY:%d" % rng.randint(0, 255)
+
+
+FLOOD_MIX = [
+    (8, slider),
+    (3, lambda rng: "SPEED:%d" % rng.randint(50, 500)),
+    (1, lambda rng: "MODE:" + rng.choice(["WAVE", "CONSTANT", "OSC"])),
+    (1, lambda rng: "LAYER:%d:WAVE:%d:%d:%s:%d" % (rng.randint(2, 4), rng.randint(0, 255),
+                                                   rng.randint(50, 500),
+                                                   rng.choice(["ADD", "MAX", "MUL", "FADE"]),
+                                                   rng.randint(0, 255))),
+    (1, lambda rng: "LIMIT:%d" % rng.randint(10, 100)),
+    (1, lambda rng: "CAL:%d" % rng.randint(1, 8)),
+    (1, lambda rng: "STATUS"),
+]
+
+
+def flood(args):
+    rng = random.Random(args.seed)
+    weights = [w for w, _ in FLOOD_MIX]
+    makers = [m for _, m in FLOOD_MIX]
+    step = 1000.0 / args.rate if args.rate > 0 else 0
+    commands = [(k * step, rng.choices(makers, weights)[0](rng)) for k in range(args.count)]
+    if args.save:
+        write_session(args.save, [(int(at), c) for at, c in commands])
+
+    link = Link(args.port, args.baud)
+    try:
+        run(link, commands, args)
+    finally:
+        link.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Record, replay and flood Smart Sheet command traffic")
+    sub = parser.add_subparsers(dest="action", required=True)
+
+    rec = sub.add_parser("record", help="capture commands from the USB console")
+    rec.add_argument("--port", required=True)
+    rec.add_argument("-o", "--output", default="session.txt")
+    rec.set_defaults(handler=record)
+
+    rep = sub.add_parser("replay", help="replay a recorded session")
+    rep.add_argument("session")
+    rep.add_argument("--speed", type=float, default=1.0, help="time scale, 0 = as fast as possible")
+    rep.add_argument("--repeat", type=int, default=1)
+    rep.set_defaults(handler=replay)
+
+    fl = sub.add_parser("flood", help="send a synthetic command mix")
+    fl.add_argument("--count", type=int, default=1000)
+    fl.add_argument("--rate", type=float, default=100.0, help="commands/s, 0 = as fast as possible")
+    fl.add_argument("--seed", type=int, default=1)
+    fl.add_argument("--save", help="also write the generated commands as a session")
+    fl.set_defaults(handler=flood)
+
+    for p in (rep, fl):
+        p.add_argument("--port", required=True, help="SPP port, USB console or simulator PTY")
+        p.add_argument("--window", type=int, default=0,
+                       help="most commands awaiting a reply, 0 = unlimited")
+        p.add_argument("--timeout", type=float, default=3.0,
+                       help="seconds to wait for outstanding replies")
+        p.add_argument("--console", help="USB console of a WAVE_DEBUG build, to time WAVE steps")
+    for p in (rec, rep, fl):
+        p.add_argument("--baud", type=int, default=115200)
+
+    args = parser.parse_args()
+    args.handler(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+Smart Sheet - Pattern library uploader
+
+Streams a library image (see pack_library.py) to the "patterns" partition
+over the Bluetooth SPP serial port, using the chunked binary protocol in
+src/upload.h. It keeps a window of chunks in flight, goes back on NAKs or
+silence, and resumes an interrupted transfer of the same image.
+
+Usage:
+    tools/upload_library.py library.bin --port /dev/rfcomm0
+    tools/upload_library.py library.bin --port COM7
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+SYNC = b"\xa5\x5a"
+HEADER = struct.Struct("<IHI")
+RETRY_SECONDS = 2.0
+
+
+def read_line(port):
+    line = port.readline()
+    return line.decode("ascii", "replace").strip() if line else None
+
+
+def send_chunk(port, image, offset, chunk_size):
+    payload = image[offset:offset + chunk_size]
+    port.write(SYNC + HEADER.pack(offset, len(payload), zlib.crc32(payload)) + payload)
+    return offset + len(payload)
+
+
+def upload(port, image):
+    crc = zlib.crc32(image)
+    port.reset_input_buffer()
+    port.write(("UPLOAD:BEGIN:%d:%08X\n" % (len(image), crc)).encode())
+
+    # Erasing the target range happens before the device answers
+    deadline = time.time() + 15
+    while True:
+        line = read_line(port)
+        if line and line.startswith("OK:UPLOAD:"):
+            resume, chunk_size, window = (int(v) for v in line.split(":")[2:5])
+            break
+        if line and line.startswith("ERROR"):
+            sys.exit("upload_library: device refused upload: " + line)
+        if time.time() > deadline:
+            sys.exit("upload_library: no answer to UPLOAD:BEGIN")
+
+    if resume:
+        print("resuming at %d of %d bytes" % (resume, len(image)))
+    acked = resume
+    sent = resume
+    last_progress = time.time()
+    started = time.time()
+
+    while True:
+        while sent < len(image) and sent < acked + window * chunk_size:
+            sent = send_chunk(port, image, sent, chunk_size)
+
+        line = read_line(port)
+        if line is None:
+            if time.time() - last_progress > RETRY_SECONDS:
+                sent = acked                    # Silence: go back and resend the window
+                last_progress = time.time()
+            continue
+
+        kind, _, value = line.partition(":")
+        if kind in ("ACK", "NAK"):
+            acked = int(value)
+            last_progress = time.time()
+            if kind == "NAK":
+                sent = acked
+            print("\r%6.1f%%" % (100.0 * acked / len(image)), end="", flush=True)
+        elif line.startswith("OK:UPLOAD:DONE:"):
+            size, ms, kbps, patterns = line.split(":")[3:7]
+            host_kbps = (len(image) - resume) / 1024 / max(time.time() - started, 1e-3)
+            print("\rdone: %s bytes in %s ms, device %s KB/s, host %.1f KB/s, %s patterns"
+                  % (size, ms, kbps, host_kbps, patterns))
+            return
+        elif line.startswith("UPLOAD:PAUSED") or line.startswith("ERROR"):
+            sys.exit("\nupload_library: " + line + " (run again to resume)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Upload a pattern library image over SPP")
+    parser.add_argument("image", help="image built by pack_library.py")
+    parser.add_argument("--port", required=True, help="SPP serial port")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    with serial.Serial(args.port, 115200, timeout=0.05) as port:
+        upload(port, image)
+
+
+if __name__ == "__main__":
+    main()